@@ -33,6 +33,27 @@ extern "C" /* platform glue */
         return static_cast< const int * >( ptr )[ -1 ];
     }
 
+    /* volatile keeps the compiler from turning the loops back into calls to
+     * memmove and memset, which call these */
+    void __vm_memmove( void *dst, const void *src, int n )
+    {
+        auto d = static_cast< volatile uint8_t * >( dst );
+        auto s = static_cast< const uint8_t * >( src );
+        if ( d < s )
+            for ( int i = 0; i < n; ++i )
+                d[ i ] = s[ i ];
+        else
+            for ( int i = n; i > 0; --i )
+                d[ i - 1 ] = s[ i - 1 ];
+    }
+
+    void __vm_memset( void *dst, int c, int n )
+    {
+        auto d = static_cast< volatile uint8_t * >( dst );
+        for ( int i = 0; i < n; ++i )
+            d[ i ] = c;
+    }
+
     static void *vmreg[ _VM_CR_Last ];
 
     void __vm_ctl_set( enum _VM_ControlRegister reg, void *val, ... )
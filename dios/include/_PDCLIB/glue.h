@@ -69,6 +69,19 @@ bool _PDCLIB_open(
 */
 int _PDCLIB_rename( const char * old, const char * newn);
 
+/* string.h */
+
+/* Copies and fills of at least _PDCLIB_BULK_MIN bytes are handed over to the
+   VM, which performs them in a single step (see __vm_memmove and __vm_memset),
+   as long as _PDCLIB_bulkmem() returns true. The weakmem transformation
+   replaces the latter with a constant false, since the bulk operations bypass
+   store buffers. The hypercalls take the size as an int, hence anything over
+   _PDCLIB_BULK_MAX bytes is done by the loop.
+*/
+#define _PDCLIB_BULK_MIN 64
+#define _PDCLIB_BULK_MAX 0x7fffffff
+bool _PDCLIB_bulkmem( void );
+
 #ifdef __cplusplus
 }
 #endif
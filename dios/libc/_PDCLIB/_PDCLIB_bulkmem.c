@@ -0,0 +1,30 @@
+/* _PDCLIB_bulkmem( void )
+
+   This file is part of the Public Domain C Library (PDCLib).
+   Permission is granted to use, modify, and / or redistribute at will.
+*/
+
+#include "_PDCLIB/glue.h"
+
+#ifndef REGTEST
+
+/* weak to keep the optimizer from folding the calls -- the weakmem
+   transformation replaces this function */
+__attribute__((__weak__, __noinline__))
+bool _PDCLIB_bulkmem( void )
+{
+    return true;
+}
+
+#endif
+
+#ifdef TEST
+#include "_PDCLIB_test.h"
+
+int main( void )
+{
+    TESTCASE( _PDCLIB_bulkmem() );
+    return TEST_RESULTS;
+}
+
+#endif
@@ -7,6 +7,8 @@
 #include <string.h>
 #include <assert.h>
 #include <stdint.h>
+#include <sys/divm.h>
+#include <_PDCLIB/glue.h>
 
 #ifndef REGTEST
 
@@ -26,6 +28,12 @@ void * memcpy( void * _PDCLIB_restrict s1, const void * _PDCLIB_restrict s2, siz
         case 8: *( uint64_t * ) dst = *( uint64_t * ) src; return s1;
         default:
         {
+            if ( n >= _PDCLIB_BULK_MIN && n <= _PDCLIB_BULK_MAX && _PDCLIB_bulkmem() )
+            {
+                __vm_memmove( s1, s2, n );
+                return s1;
+            }
+
             while ( ( uint64_t ) dst % 8 && ( uint64_t ) src % 8 && n )
                 *dst++ = *src++, n --;
 
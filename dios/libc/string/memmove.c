@@ -7,6 +7,7 @@
 #include <string.h>
 #include <stdint.h>
 #include <sys/divm.h>
+#include <_PDCLIB/glue.h>
 
 #ifndef REGTEST
 
@@ -15,6 +16,13 @@ void * memmove( void * s1, const void * s2, size_t n )
 {
     char *dest = ( char * ) s1;
     const char *src = ( const char * ) s2;
+
+    if ( n >= _PDCLIB_BULK_MIN && n <= _PDCLIB_BULK_MAX && _PDCLIB_bulkmem() )
+    {
+        __vm_memmove( s1, s2, n );
+        return s1;
+    }
+
     if ( dest <= src ) {
         while ( ( uint64_t ) dest % 8 && ( uint64_t ) src % 8 && n ) {
             *dest++ = *src++;
@@ -6,6 +6,7 @@
 
 #include <string.h>
 #include <sys/divm.h>
+#include <_PDCLIB/glue.h>
 
 #ifndef REGTEST
 
@@ -13,6 +14,12 @@ __attribute__((__annotate__("lart.interrupt.skipcfl")))
 __attribute__((__annotate__("divine.link.always")))
 void * memset( void * s, int c, size_t n )
 {
+    if ( n >= _PDCLIB_BULK_MIN && n <= _PDCLIB_BULK_MAX && _PDCLIB_bulkmem() )
+    {
+        __vm_memset( s, c, n );
+        return s;
+    }
+
     unsigned char * p = (unsigned char *) s;
     while ( n-- )
     {
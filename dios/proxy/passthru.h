@@ -129,25 +129,37 @@ namespace fs {
             Next::finalize();
         }
 
+        /* Each call is recorded as a single write to the trace (see
+         * replay-trace.h for the format), instead of one per field. */
         template< typename ret >
-        void writeOut( UnVoid <ret>& output )
+        void writeOut( int sysnum, UnVoid <ret>& output )
         {
             // for parsing we need to know the  length of data first
-            size_t fullFize = 0;
+            size_t fullSize = 0;
             for ( auto& word : _out )
             {
-                fullFize += word.size();
+                fullSize += word.size();
             }
 
-            fullFize += sizeof( *output.address());
-            __dios_trace_out( reinterpret_cast<const char *>(&fullFize), sizeof( &fullFize ));
+            fullSize += sizeof( *output.address());
 
-            for ( auto it = _out.rbegin(); it != _out.rend(); ++it )
+            String record;
+            auto add = [&]( const void *data, size_t size )
             {
-                __dios_trace_out( it->data(), it->size());
-            }
+                record.append( reinterpret_cast< const char * >( data ), size );
+            };
+
+            record.reserve( 8 + sizeof( int ) + sizeof( size_t ) + fullSize + sizeof( int ) );
+            add( "SYSCALL:", 8 );
+            add( &sysnum, sizeof( int ) );
+            add( &fullSize, sizeof( fullSize ) );
+            for ( auto it = _out.rbegin(); it != _out.rend(); ++it )
+                add( it->data(), it->size() );
             _out.clear();
-            __dios_trace_out( reinterpret_cast<const char *>(output.address()), sizeof( *output.address()));
+            add( output.address(), sizeof( *output.address() ) );
+            add( __dios_errno(), sizeof( *__dios_errno() ) );
+
+            __dios_trace_out( record.data(), record.size() );
         }
 
 
@@ -162,14 +174,11 @@ namespace fs {
                     case 4 :  outType = _VM_SC_Int32 | _VM_SC_Out ; break;   \
                     case 8 : outType = _VM_SC_Int64 | _VM_SC_Out ; break;    \
                 }                                                            \
-                __dios_trace_out("SYSCALL:", 8); \
                 int sysnum = static_cast<int>(_HOST_SYS_ ## name);\
-                __dios_trace_out(reinterpret_cast<const char *>(&sysnum), sizeof(int)); \
                 auto input =  std::make_tuple(_HOST_SYS_ ## name, outType, rv.address()); \
                  *__dios_errno() = 0;\
                 *__dios_errno() =  parse(_out, input, _1, _2, _3, _4, _5, _6, _7); \
-                writeOut(rv);\
-                __dios_trace_out(reinterpret_cast<const char *>(__dios_errno()), sizeof(*__dios_errno())); \
+                writeOut(sysnum, rv);\
                 return rv.get();\
             }
 
@@ -196,14 +205,11 @@ namespace fs {
             {
                 mode = 0;
             }
-            __dios_trace_out( "SYSCALL:", 8 );
             int sysnum = static_cast<int>(_HOST_SYS_open);
-            __dios_trace_out( reinterpret_cast<const char *>(&sysnum), sizeof( int ));
             auto input = std::make_tuple( _HOST_SYS_open, outType, rv.address());
             *__dios_errno() = 0;
             *__dios_errno() = parse( _out, input, Mem< const char * >( pathname ), flags, mode, _4 );
-            writeOut( rv );
-            __dios_trace_out( reinterpret_cast<const char *>(__dios_errno()), sizeof( *__dios_errno()));
+            writeOut( sysnum, rv );
             return rv.get();
         }
 
@@ -220,9 +226,7 @@ namespace fs {
                     outType = _VM_SC_Int64 | _VM_SC_Out;
                     break;
             }
-            __dios_trace_out( "SYSCALL:", 8 );
             int sysnum = static_cast<int>(_HOST_SYS_fcntl);
-            __dios_trace_out( reinterpret_cast<const char *>(&sysnum), sizeof( int ));
             *__dios_errno() = 0;
             switch ( cmd )
             {
@@ -244,8 +248,7 @@ namespace fs {
                     va_end( *vl );
                 }
             }
-            writeOut( rv );
-            __dios_trace_out( reinterpret_cast<const char *>(__dios_errno()), sizeof( *__dios_errno()));
+            writeOut( sysnum, rv );
             return rv.get();
         }
 
@@ -9,16 +9,6 @@
 namespace __dios
 {
 
-struct SyscallSnapshot 
-{
-    int number;
-    String _inputs;
-    int _errno;
-    SyscallSnapshot *next;
-};
-
-using syscallSet = __dios::Set< SyscallSnapshot * >;
-
 template< typename Type >
 bool getArg( String& _inputs, Out <Type> process ) 
 {
@@ -0,0 +1,152 @@
+// -*- C++ -*- (c) 2026 agent <agent@local>
+
+#ifndef _FS_REPLAY_TRACE_H_
+#define _FS_REPLAY_TRACE_H_
+
+/*
+ * Syscall traces, as recorded in passthrough mode and consumed in replay
+ * mode. This header is shared between DiOS and host-side tools, hence it only
+ * depends on the C++ standard library.
+ *
+ * The recorded (stream) format is a sequence of records, each of them
+ *
+ *     "SYSCALL:" | int number | size_t length | char data[ length ] | int errno
+ *
+ * which is convenient to append to, but needs to be scanned from the start to
+ * find a particular record. The indexed format has the same records, laid out
+ * so that the n-th one can be found directly:
+ *
+ *     Header { "DIOSRPL1", uint64_t count }
+ *     uint64_t offset[ count ]    -- of each record, from the start of the file
+ *     Record { int32_t number, error; uint64_t length } | char data[ length ]
+ *
+ * All numbers are in host byte order (traces are not portable between hosts
+ * anyway, since the syscall numbers are host-specific).
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+namespace __dios::replay
+{
+
+static const char magic[ 8 ] = { 'D', 'I', 'O', 'S', 'R', 'P', 'L', '1' };
+static const char stream_tag[ 8 ] = { 'S', 'Y', 'S', 'C', 'A', 'L', 'L', ':' };
+
+struct Header
+{
+    char magic[ 8 ];
+    uint64_t count;
+};
+
+struct Record
+{
+    int32_t number, error;
+    uint64_t length;
+    const char *data() const { return reinterpret_cast< const char * >( this + 1 ); }
+};
+
+template< typename T >
+static T load( const char *p )
+{
+    T v;
+    std::memcpy( &v, p, sizeof( T ) );
+    return v;
+}
+
+static inline bool is_indexed( const char *buf, size_t size )
+{
+    return size >= sizeof( Header ) && std::memcmp( buf, magic, sizeof( magic ) ) == 0;
+}
+
+/* Check that the index of an indexed trace fits in the buffer. Records are
+ * only checked when they are looked up, which keeps loading the trace O(1). */
+static inline bool valid_indexed( const char *buf, size_t size )
+{
+    return is_indexed( buf, size ) &&
+           load< uint64_t >( buf + 8 ) <= ( size - sizeof( Header ) ) / sizeof( uint64_t );
+}
+
+static inline uint64_t count( const char *buf )
+{
+    return load< uint64_t >( buf + 8 );
+}
+
+/* the record number idx of a valid indexed trace, or nullptr if it is damaged */
+static inline const Record *record( const char *buf, size_t size, uint64_t idx )
+{
+    auto off = load< uint64_t >( buf + sizeof( Header ) + idx * sizeof( uint64_t ) );
+
+    if ( off % alignof( Record ) || off > size || size - off < sizeof( Record ) ||
+         size - off - sizeof( Record ) < load< Record >( buf + off ).length )
+        return nullptr;
+
+    return reinterpret_cast< const Record * >( buf + off );
+}
+
+/* Scan a trace in the stream format, calling yield( number, error, data,
+ * length ) for each record. Returns false if the trace is malformed. */
+template< typename Yield >
+bool scan_stream( const char *buf, size_t size, Yield yield )
+{
+    const size_t fixed = sizeof( stream_tag ) + sizeof( int ) + sizeof( size_t ) + sizeof( int );
+
+    for ( size_t pos = 0; pos < size; )
+    {
+        if ( size - pos < fixed || std::memcmp( buf + pos, stream_tag, sizeof( stream_tag ) ) )
+            return false;
+
+        const char *p = buf + pos + sizeof( stream_tag );
+        int number = load< int >( p );
+        size_t length = load< size_t >( p + sizeof( int ) );
+        const char *data = p + sizeof( int ) + sizeof( size_t );
+
+        if ( length > size - pos - fixed )
+            return false;
+
+        yield( number, load< int >( data + length ), data, length );
+        pos += fixed + length;
+    }
+
+    return true;
+}
+
+/* Convert a stream trace to the indexed format. The output is written through
+ * resize( n ) and operator[], which makes it usable with most string types. */
+template< typename Out >
+bool index_stream( const char *buf, size_t size, Out &out )
+{
+    auto align = []( uint64_t n ) { return ( n + alignof( Record ) - 1 ) / alignof( Record ) * alignof( Record ); };
+    uint64_t count = 0, bytes = 0;
+
+    if ( !scan_stream( buf, size, [&]( int, int, const char *, size_t length )
+                       {
+                           ++count;
+                           bytes += align( sizeof( Record ) + length );
+                       } ) )
+        return false;
+
+    uint64_t off = align( sizeof( Header ) + count * sizeof( uint64_t ) ), idx = 0;
+    out.resize( off + bytes );
+    char *o = &out[ 0 ];
+
+    std::memset( o, 0, off + bytes );
+    std::memcpy( o, magic, sizeof( magic ) );
+    std::memcpy( o + 8, &count, sizeof( count ) );
+
+    scan_stream( buf, size, [&]( int number, int error, const char *data, size_t length )
+    {
+        Record r{ number, error, length };
+        std::memcpy( o + sizeof( Header ) + idx++ * sizeof( uint64_t ), &off, sizeof( off ) );
+        std::memcpy( o + off, &r, sizeof( r ) );
+        std::memcpy( o + off + sizeof( r ), data, length );
+        off += align( sizeof( Record ) + length );
+    } );
+
+    return true;
+}
+
+}
+
+#endif // _FS_REPLAY_TRACE_H_
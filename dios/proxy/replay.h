@@ -23,6 +23,7 @@
 #include <dios/sys/stdlibwrap.hpp>
 #include <dios/proxy/passthru-types.h>
 #include <dios/proxy/replay-parse.h>
+#include <dios/proxy/replay-trace.h>
 
 
 using String = __dios::String;
@@ -58,16 +59,16 @@ struct Replay : public Next {
 
     void finalize()
     {
-        while ( !_currents.empty()) {
-            SyscallSnapshot *node = *_currents.begin();
-            _currents.erase( node );
-            if ( node->next != nullptr )
-                _currents.insert( node->next );
-            __vm_obj_free( node );
-        }
+        _trace.clear();
         Next::finalize();
     }
 
+    /* The entire trace is read into memory using a few large reads. A trace
+     * in the indexed format (see replay-trace.h) is used as it is; a recorded
+     * one is indexed first, which is much slower (it happens in the
+     * interpreter), so long traces should be converted using the
+     * replay-index tool beforehand. Either way, the trace is an
+     * immutable heap object, shared by all the states that refer to it. */
     bool init( const String& name ) {
         int fd = -1;
         const char *filename = name.c_str();
@@ -83,8 +84,16 @@ struct Replay : public Next {
             return false;
         }
 
-        bool success = false;
-        success = parseFile( fd );
+        bool success = readFile( fd );
+
+        if ( success && !replay::is_indexed( _trace.data(), _trace.size() ) )
+        {
+            String indexed;
+            success = replay::index_stream( _trace.data(), _trace.size(), indexed );
+            _trace = std::move( indexed );
+        }
+
+        success = success && replay::valid_indexed( _trace.data(), _trace.size() );
 
         if ( !success ) {
             __dios_trace_f( "Error by parsing the file: %s\n", filename );
@@ -109,95 +118,24 @@ struct Replay : public Next {
         return red;
     }
 
-    bool parseFile( int fd )
+    bool readFile( int fd )
     {
-        SyscallSnapshot *prev = nullptr;
-        SyscallSnapshot *next = nullptr;
-        while ( true ) {
-            next = new_object< SyscallSnapshot >();
-            bool stop = false;
-            if ( !getSyscall( fd, next, &stop ))
-            {
-                __vm_obj_free( next );
-                return false;
-            }
+        const int block = 1 << 20;
+        size_t size = 0;
 
-            if ( stop )
-            {
-                return true;
-            }
-
-            if ( prev == nullptr )
-            {
-                _currents.insert( next );
-                prev = next;
-            } else
-            {
-                prev->next = next;
-                prev = next;
-            }
-        }
-    }
-
-    bool getSyscall( int fd, SyscallSnapshot *snapshot, bool *shouldStop )
-    {
-        ssize_t red = 0;
-        size_t length = 8 + sizeof( int ); //8 for SYSCALL:
-        char nameBuf[length];
-        int sysNumber = 0;
-
-        red = readWrap( fd, nameBuf, length );
-
-        //No data left
-        if ( red == 0 )
-        {
-            *shouldStop = true;
-            return true;
-        }
-
-        if ( red != length )
+        while ( true )
         {
-            return false;
-        }
-
-        if ( strncmp( "SYSCALL:", nameBuf, 8 ))
-        {
-            return false;
-        }
-
-        //NAME
-        char *number = nameBuf + 8;
-        snapshot->number = *reinterpret_cast< int *>(number);
-
-        //INPUT DATA + OUTPUT
-        length = sizeof( size_t ); //for inputData length
-        char inputDataLength[length];
-
-        red = readWrap( fd, inputDataLength, length );
-        if ( red != length ) {
-            return false;
-        }
-
-        size_t inputLength = *reinterpret_cast< size_t *>(inputDataLength);
-        char inputData[inputLength];
-
-        red = readWrap( fd, inputData, inputLength );
-        if ( red != inputLength ) {
-            return false;
+            _trace.resize( size + block );
+            ssize_t red = readWrap( fd, &_trace[ size ], block );
+            if ( red < 0 )
+                return false;
+            size += red;
+            if ( red == 0 )
+                break;
         }
 
-        snapshot->_inputs = String( inputData, inputLength );
-
-        //ERRNO
-        length = sizeof( int );
-        char errnoBuf[length];
-        red = readWrap( fd, errnoBuf, length );
-        if ( red != length )
-            return false;
-        snapshot->_errno = *reinterpret_cast< int * >(errnoBuf);
-
+        _trace.resize( size );
         return true;
-
     }
 
                 //TODO : line 205 + 199 - co urobit ak zle!
@@ -234,34 +172,34 @@ struct Replay : public Next {
         gives a guess if it is even reasonable to try parsing given system call
         can be extended by some heuristics in the future
         */
+        const replay::Record *current()
+        {
+            if ( _next >= replay::count( _trace.data() ) )
+                return nullptr;
+            return replay::record( _trace.data(), _trace.size(), _next );
+        }
+
         bool isProcessible( int sysNumber )
         {
-            for ( auto& item : _currents )
-            {
-                if ( item->number == sysNumber )
-                    return true;
-            }
-            return false;
+            auto item = current();
+            return item && item->number == sysNumber;
         }
 
+        /* the calls are replayed in the order in which they were recorded */
         template< typename Out, class... Args >
         bool parse( int sysNumber, UnVoid <Out>& rv, Args ... args )
         {
-            for ( auto& item : _currents ) {
-                if ( item->number == sysNumber ) {
-                    //need to make copy of the string
-                    auto copy = item->_inputs;
-                    if ( tryParse( copy, rv, args... )) {
-                        if ( item->next )
-                            _currents.insert( item->next );
-                        *__dios_errno() = item->_errno;
-                        _currents.erase( item );
-                        // __vm_obj_free(item); //TODO delete this memory
-                        return true;
-                    }
-                }
-            }
-            return false;
+            auto item = current();
+            if ( !item || item->number != sysNumber )
+                return false;
+
+            String inputs( item->data(), item->length );
+            if ( !tryParse( inputs, rv, args... ) )
+                return false;
+
+            *__dios_errno() = item->error;
+            ++ _next;
+            return true;
         }
 
         int open( const char *pathname, OFlags flags, mode_t mode )
@@ -343,8 +281,8 @@ struct Replay : public Next {
 
 
     private:
-        syscallSet _currents;
-        String _rest;
+        String _trace;
+        uint64_t _next = 0;
     };
 
 } // namespace fs
@@ -32,19 +32,39 @@
 namespace __dios::fs
 {
 
-/* A name and a pointer to corresponding inode */
+/* A name and a pointer to corresponding inode. The first 8 bytes of the name
+ * are also kept in an integer (big endian, zero padded), which orders the
+ * same way as the names themselves do, up to a tie. Lookups mostly compare
+ * those and only rarely need to look at the names proper. */
 struct DirectoryEntry
 {
     DirectoryEntry( std::string_view name, Node inode ) :
-        _inode( std::move( inode ) )
+        _key( key( name ) ), _inode( std::move( inode ) )
     {
         _name.assign( name.size(), name.begin(), name.end() );
     }
 
+    static uint64_t key( std::string_view name )
+    {
+        uint64_t k = 0;
+        for ( int i = 0; i < 8; ++i )
+            k = k << 8 | ( i < int( name.size() ) ? uint8_t( name[ i ] ) : 0 );
+        return k;
+    }
+
     std::string_view name() const { return { _name.begin(), _name.size() }; }
     Node inode() const { return _inode; }
 
+    /* compare with a name whose key is 'k' */
+    int compare( uint64_t k, std::string_view name ) const
+    {
+        if ( _key != k )
+            return _key < k ? -1 : 1;
+        return this->name().compare( name );
+    }
+
 private:
+    uint64_t _key;
     Array< char > _name;
     Node _inode;
 };
@@ -100,7 +120,7 @@ struct Directory : INode
             return _parent ? _parent : this;
 
         auto position = _findItem( name );
-        if ( position == _items.end() || name != position->name() )
+        if ( position == _items.end() )
             return Node();
         return position->inode();
     }
@@ -108,7 +128,7 @@ struct Directory : INode
     bool unlink( std::string_view name )
     {
         auto position = _findItem( name );
-        if ( position == _items.end() || name != position->name() )
+        if ( position == _items.end() )
             return error( ENOENT ), false;
         else
         {
@@ -155,7 +175,7 @@ private:
 
     bool _insertItem( DirectoryEntry &&entry, bool force )
     {
-        auto position = _findItem( entry.name() );
+        auto position = _lowerBound( DirectoryEntry::key( entry.name() ), entry.name() );
         if ( position == _items.end() )
             _items.emplace_back( std::move( entry ) );
         else if ( position->name() != entry.name() )
@@ -167,17 +187,28 @@ private:
         return true;
     }
 
-    Items::iterator _findItem( std::string_view name )
+    /* the items are kept sorted by name, which is also the order of readdir */
+    Items::iterator _lowerBound( uint64_t key, std::string_view name )
     {
         return std::lower_bound(
             _items.begin(),
             _items.end(),
             name,
-            []( const DirectoryEntry &entry, std::string_view name ) {
-                return entry.name() < name;
+            [key]( const DirectoryEntry &entry, std::string_view name ) {
+                return entry.compare( key, name ) < 0;
             } );
     }
 
+    /* the entry with the given name, or _items.end() */
+    Items::iterator _findItem( std::string_view name )
+    {
+        auto key = DirectoryEntry::key( name );
+        auto position = _lowerBound( key, name );
+        if ( position != _items.end() && position->compare( key, name ) != 0 )
+            return _items.end();
+        return position;
+    }
+
     Items _items;
     Node _parent;
 };
@@ -46,15 +46,26 @@ private:
     Array< char > _target;
 };
 
+/* The content of a regular file is split into chunks of chunk_size bytes,
+ * each a separate heap object, so that a write only touches the chunks it
+ * overlaps and growing a file never copies the data already there. This
+ * matters for snapshots: only the modified chunks become dirty, instead of
+ * the entire file. A chunk which was never written is not allocated at all
+ * (it reads as zeroes); the others are exactly as long as the part of the
+ * file they cover, i.e. only the last one can be shorter than chunk_size. */
+
 struct RegularFile : INode
 {
+    static constexpr size_t chunk_size = 4096;
+    using Chunk = Array< char >;
+
     RegularFile() = default;
 
     RegularFile( const RegularFile &other ) = default;
     RegularFile( RegularFile &&other ) = default;
     RegularFile &operator=( RegularFile ) = delete;
 
-    size_t size() const override { return _content.size(); }
+    size_t size() const override { return _size; }
     bool canRead() const override { return true; }
     bool canWrite( int, Node ) const override { return true; }
 
@@ -66,35 +77,74 @@ struct RegularFile : INode
             return true;
         }
 
-        auto begin = _content.begin() + offset;
         if ( offset + length > size() )
             length = size() - offset;
-        std::copy( begin, begin + length, buffer );
+
+        for ( size_t done = 0, todo; done < length; done += todo )
+        {
+            size_t pos = offset + done, off = pos % chunk_size;
+            auto &chunk = _chunks[ pos / chunk_size ];
+            todo = std::min( length - done, chunk_size - off );
+
+            if ( chunk.empty() )
+                std::fill( buffer + done, buffer + done + todo, 0 );
+            else
+                std::copy( chunk.begin() + off, chunk.begin() + off + todo, buffer + done );
+        }
+
         return true;
     }
 
     bool write( const char *buffer, size_t offset, size_t &length, Node ) override
     {
-        if ( _content.size() < offset + length )
+        if ( _size < offset + length )
             resize( offset + length );
 
-        std::copy( buffer, buffer + length, _content.begin() + offset );
+        for ( size_t done = 0, todo; done < length; done += todo )
+        {
+            size_t pos = offset + done, idx = pos / chunk_size, off = pos % chunk_size;
+            auto &chunk = _chunks[ idx ];
+            todo = std::min( length - done, chunk_size - off );
+
+            if ( chunk.empty() )
+                chunk.resize( chunk_length( idx ) );
+            std::copy( buffer + done, buffer + done + todo, chunk.begin() + off );
+        }
+
         return true;
     }
 
     void resize( size_t length )
     {
-        _content.resize( length );
+        size_t count = ( length + chunk_size - 1 ) / chunk_size;
+
+        while ( size_t( _chunks.size() ) > count )
+            _chunks.pop_back();
+
+        _size = length;
+
+        if ( count && !_chunks.empty() && !_chunks.back().empty() )
+            _chunks.back().resize( chunk_length( _chunks.size() - 1 ) );
+
+        if ( size_t( _chunks.size() ) < count )
+            _chunks.resize( count );
     }
 
     void content( std::string_view s )
     {
-        resize( s.size() );
-        std::copy( s.begin(), s.end(), _content.begin() );
+        resize( 0 );
+        size_t length = s.size();
+        write( s.data(), 0, length, nullptr );
     }
 
 private:
-    Array< char > _content;
+    size_t chunk_length( size_t idx ) const
+    {
+        return std::min( chunk_size, _size - idx * chunk_size );
+    }
+
+    Array< Chunk > _chunks;
+    size_t _size = 0;
 };
 
 /* Each write is propagated to the trace/counterexample. */
@@ -88,6 +88,14 @@ namespace divine::cc
             mapVirtualFile( brq::join_path( "/builtin/", src->n ), src->c );
     }
 
+    CC1::CC1( const CC1 &o, std::shared_ptr< llvm::LLVMContext > ctx ) :
+        divineVFS( o.divineVFS ),
+        overlayFS( new clang::vfs::OverlayFileSystem( clang::vfs::getRealFileSystem() ) ),
+        ctx( ctx ? ctx : std::make_shared< llvm::LLVMContext >() )
+    {
+        overlayFS->pushOverlay( divineVFS );
+    }
+
     CC1::~CC1() { }
 
     void CC1::mapVirtualFile( std::string path, std::string contents )
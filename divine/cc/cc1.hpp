@@ -66,6 +66,10 @@ namespace divine::cc
     struct CC1
     {
         explicit CC1( std::shared_ptr< llvm::LLVMContext > ctx = nullptr );
+        /* A compiler for use in another thread: it sees the same mapped files
+         * and allowed paths as 'o' (which must not change while both are in
+         * use), but has a context of its own. */
+        CC1( const CC1 &o, std::shared_ptr< llvm::LLVMContext > ctx );
         ~CC1();
 
         void mapVirtualFile( std::string path, std::string_view contents );
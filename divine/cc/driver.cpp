@@ -23,6 +23,9 @@
 #include <brick-string>
 #include <brick-types>
 
+#include <atomic>
+#include <future>
+
 namespace divine::cc
 {
     using namespace std::literals;
@@ -102,6 +105,14 @@ namespace divine::cc
     // Append the necessary and provided flags and defer to the compiler
     std::unique_ptr< llvm::Module > Driver::compile( std::string path,
                                         FileType type, std::vector< std::string > flags )
+    {
+        compiler.allowIncludePath( "." ); /* clang 4.0 requires that cwd is always accessible */
+        compiler.allowIncludePath( brq::dirname( path ) );
+        return compile( compiler, path, type, flags );
+    }
+
+    std::unique_ptr< llvm::Module > Driver::compile( CC1 &cc, std::string path,
+                                        FileType type, std::vector< std::string > flags )
     {
         using FT = FileType;
 
@@ -113,13 +124,9 @@ namespace divine::cc
         std::copy( commonFlags.begin(), commonFlags.end(), std::back_inserter( allFlags ) );
         std::copy( flags.begin(), flags.end(), std::back_inserter( allFlags ) );
         if ( opts.verbose )
-            std::cerr << "compiling " << path << std::endl;
-
-        compiler.allowIncludePath( "." ); /* clang 4.0 requires that cwd is always accessible */
-        compiler.allowIncludePath( brq::dirname( path ) );
-        auto mod = compiler.compile( path, type, allFlags );
+            std::cerr << "compiling " + path + "\n" << std::flush;
 
-        return mod;
+        return cc.compile( path, type, allFlags );
     }
 
     // Compile all the files and link them together, including necessary libraries
@@ -128,6 +135,9 @@ namespace divine::cc
         for ( auto path : po.allowedPaths )
             compiler.allowIncludePath( path );
 
+        if ( po.jobs > 1 )
+            return build_parallel( po );
+
         for ( auto &f : po.files )
         {
             f.match(
@@ -143,6 +153,74 @@ namespace divine::cc
         }
     }
 
+    /* Like build, but with po.jobs threads compiling the files, each using a
+     * compiler with a separate LLVM context. Modules cannot move between
+     * contexts, hence they are handed over as bitcode. Linking is sequential
+     * and in the original order, interleaved with the libraries as given. A
+     * compile error is reported for the first failing file (in order), but
+     * only after all files have been compiled. */
+    void Driver::build_parallel( ParsedOpts po )
+    {
+        std::vector< const File * > files;
+        for ( auto &f : po.files )
+            f.match( [&]( const File &f ) { files.push_back( &f ); }, []( const Lib & ) {} );
+
+        /* the threads share the VFS of 'compiler', which must not change from now on */
+        compiler.allowIncludePath( "." );
+        for ( auto f : files )
+            compiler.allowIncludePath( brq::dirname( f->name ) );
+
+        std::vector< std::string > bitcode( files.size() );
+        std::vector< std::exception_ptr > errors( files.size() );
+        std::atomic< size_t > next( 0 );
+
+        auto worker = [&]
+        {
+            CC1 cc( compiler, nullptr );
+            for ( size_t i; ( i = next++ ) < files.size(); )
+                try
+                {
+                    if ( auto m = compile( cc, files[ i ]->name, files[ i ]->type, po.opts ) )
+                        bitcode[ i ] = CC1::serializeModule( *m );
+                }
+                catch ( ... )
+                {
+                    errors[ i ] = std::current_exception();
+                }
+        };
+
+        std::vector< std::future< void > > threads;
+        for ( size_t i = 0; i < std::min( size_t( po.jobs ), files.size() ); ++i )
+            threads.push_back( std::async( std::launch::async, worker ) );
+        for ( auto &t : threads )
+            t.get();
+
+        for ( auto &e : errors )
+            if ( e )
+                std::rethrow_exception( e );
+
+        size_t i = 0;
+        for ( auto &f : po.files )
+        {
+            f.match(
+                [&]( const File &f )
+                {
+                    auto &bc = bitcode[ i++ ];
+                    if ( bc.empty() )
+                        return;
+                    auto parsed = llvm::parseBitcodeFile( llvm::MemoryBufferRef( bc, f.name ),
+                                                          *context() );
+                    if ( !parsed )
+                        throw std::runtime_error( "could not parse bitcode of " + f.name );
+                    linker->link( std::move( parsed.get() ) );
+                },
+                [&]( const Lib &l )
+                {
+                    linkLib( l.name, po.libSearchPath );
+                } );
+        }
+    }
+
     std::unique_ptr< llvm::Module > Driver::takeLinked()
     {
         brick::llvm::verifyModule( linker->get() );
@@ -89,8 +89,10 @@ namespace divine::cc
 
         ModulePtr compile( std::string path, std::vector< std::string > flags = {} );
         ModulePtr compile( std::string path, FileType type, std::vector< std::string > flags = {} );
+        ModulePtr compile( CC1 &cc, std::string path, FileType type, std::vector< std::string > flags );
 
         virtual void build( ParsedOpts po );
+        void build_parallel( ParsedOpts po );
 
         std::unique_ptr< llvm::Module > takeLinked();
         void writeToFile( std::string filename );
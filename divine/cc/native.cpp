@@ -23,6 +23,9 @@
 #include <divine/cc/options.hpp>
 #include <iterator> // std::next
 
+#include <atomic>
+#include <future>
+
 DIVINE_RELAX_WARNINGS
 #include "lld/Common/Driver.h"
 DIVINE_UNRELAX_WARNINGS
@@ -44,6 +47,9 @@ namespace divine::cc
     // Compile all files that are neither libraries nor already object files
     int Native::compile_files()
     {
+        if ( _po.jobs > 1 )
+            return compile_files_parallel();
+
         for ( auto file : _files )
         {
             if ( file.first == "lib" )
@@ -59,6 +65,51 @@ namespace divine::cc
         return 0;
     }
 
+    /* Like compile_files, but using _po.jobs threads, each with a compiler of
+     * its own (see Driver::build_parallel). Every file goes into a separate
+     * object, so the order of completion does not matter; the first error in
+     * command-line order is rethrown once all threads are done. */
+    int Native::compile_files_parallel()
+    {
+        std::vector< const PairedFiles::value_type * > todo;
+        for ( auto &file : _files )
+            if ( file.first != "lib" && !cc::is_object_type( file.first ) )
+                todo.push_back( &file );
+
+        auto drv_args = _po.cc1_args;
+        add( drv_args, _po.opts );
+
+        std::vector< std::exception_ptr > errors( todo.size() );
+        std::atomic< size_t > next( 0 );
+
+        auto worker = [&]
+        {
+            cc::CC1 cc( _clang, nullptr );
+            for ( size_t i; ( i = next++ ) < todo.size(); )
+                try
+                {
+                    TRACE( "compile:", todo[ i ]->first, drv_args );
+                    auto mod = cc.compile( todo[ i ]->first, drv_args );
+                    cc::emit_obj_file( *mod, todo[ i ]->second, _po.pic );
+                }
+                catch ( ... )
+                {
+                    errors[ i ] = std::current_exception();
+                }
+        };
+
+        std::vector< std::future< void > > threads;
+        for ( size_t i = 0; i < std::min( size_t( _po.jobs ), todo.size() ); ++i )
+            threads.push_back( std::async( std::launch::async, worker ) );
+        for ( auto &t : threads )
+            t.get();
+
+        for ( auto &e : errors )
+            if ( e )
+                std::rethrow_exception( e );
+        return 0;
+    }
+
     void Native::preprocess_only()
     {
         for ( auto srcFile : _po.files )
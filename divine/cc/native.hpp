@@ -96,6 +96,7 @@ namespace divine::cc
         }
 
         int compile_files();
+        int compile_files_parallel();
         void init_ld_args();
         virtual void link();
         void preprocess_only();
@@ -15,6 +15,9 @@
 #include <divine/cc/options.hpp>
 #include <brick-string>
 
+#include <iterator>
+#include <stdexcept>
+
 namespace divine::cc
 {
     // Parse CLI options (switches and files) and process them into a form understood by the driver
@@ -86,6 +89,16 @@ namespace divine::cc
                 po.allowedPaths.emplace_back( val );
                 po.libSearchPath.emplace_back( std::move( val ) );
             }
+            else if ( *it == "-j" || ( brq::starts_with( *it, "-j" ) && std::isdigit( ( *it )[ 2 ] ) ) )
+            {
+                if ( it->size() == 2 && std::next( it ) == end )
+                    throw std::runtime_error( "-j requires a number of jobs" );
+                std::string val = it->size() > 2 ? it->substr( 2 ) : *++it;
+                size_t len = 0;
+                try { po.jobs = std::max( 1, std::stoi( val, &len ) ); } catch ( std::logic_error & ) {}
+                if ( !len || len != val.size() )
+                    throw std::runtime_error( "-j value not recognized: " + val );
+            }
             else if ( brq::starts_with( *it, "-o" ))
             {
                 std::string val;
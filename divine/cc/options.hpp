@@ -46,6 +46,7 @@ namespace divine::cc
         bool use_lld = false;
         bool shared = false;
         bool pic = false;
+        int jobs = 1; /* translation units compiled in parallel (-j N) */
     };
 
     ParsedOpts parseOpts( std::vector< std::string > rawCCOpts );
@@ -93,10 +93,18 @@ struct BitCode
     std::unique_ptr< dbg::Info > _dbg;
 
     std::string _solver;
+    bool _tree_compression = false, _cold_compression = false, _record_edges = false,
+         _state_table_hashes = false;
+    int64_t _state_table_size = 0;
     BCOptions _opts;
 
     bool is_symbolic() const { return _opts.symbolic; }
     std::string solver() const { ASSERT( is_symbolic() ); return _solver; }
+    bool tree_compression() const { return _tree_compression; }
+    bool cold_compression() const { return _cold_compression; }
+    bool record_edges() const { return _record_edges; }
+    int64_t state_table_size() const { return _state_table_size; }
+    bool state_table_hashes() const { return _state_table_hashes; }
 
     vm::Program &program() { ASSERT( _program.get() ); return *_program.get(); }
     dbg::Info &debug() { ASSERT( _dbg.get() ); return *_dbg.get(); }
@@ -107,6 +115,11 @@ struct BitCode
 
     void set_options( const BCOptions& opts ) { _opts = opts; }
     void solver( std::string s ) { _solver = s; }
+    void tree_compression( bool t ) { _tree_compression = t; }
+    void cold_compression( bool c ) { _cold_compression = c; }
+    void record_edges( bool r ) { _record_edges = r; }
+    void state_table_size( int64_t s ) { _state_table_size = s; }
+    void state_table_hashes( bool h ) { _state_table_hashes = h; }
 
     void do_lart();
     void do_dios();
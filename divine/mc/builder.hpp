@@ -69,12 +69,14 @@ struct Builder
         std::vector< std::string > trace;
         std::vector< vm::Choice > stack;
         std::vector< vm::Interrupt > interrupts;
+        vm::GenericPointer task; /* reported by the scheduler, if any */
+        int buchi = 0; /* the target automaton state in mc::Product */
         bool accepting:1;
         bool error:1;
         auto as_tuple() const
         {
             /* skip the text trace for comparison purposes */
-            return std::make_tuple( stack, interrupts, accepting, error );
+            return std::make_tuple( stack, interrupts, accepting, error, buchi );
         }
     };
 
@@ -95,7 +97,8 @@ struct Builder
         vm::CowHeap::Pool pool;
 
         int64_t local_instructions = 0, local_states = 0;
-        std::shared_ptr< std::atomic< int64_t > > total_instructions, total_states;
+        std::shared_ptr< std::atomic< int64_t > > total_instructions, total_states, dropped;
+        std::shared_ptr< std::atomic< bool > > saturated; /* see store() */
 
         template< typename... Args >
         Data( BC bc, Args... solver_opts )
@@ -106,8 +109,19 @@ struct Builder
         Data( BC bc, const Context &ctx, HT states, Args... solver_opts )
             : bc( bc ), ctx( ctx ), states( states ), solver( solver_opts... ),
               total_instructions( new std::atomic< int64_t >( 0 ) ),
-              total_states( new std::atomic< int64_t >( 0 ) )
-        {}
+              total_states( new std::atomic< int64_t >( 0 ) ),
+              dropped( new std::atomic< int64_t >( 0 ) ),
+              saturated( new std::atomic< bool >( false ) )
+        {
+            if ( bc->tree_compression() )
+                this->ctx.heap().tree_compression( pool );
+            if ( bc->cold_compression() )
+                this->ctx.heap().cold_compression( pool );
+            if ( bc->state_table_hashes() )
+                this->states.keep_hashes();
+            if ( bc->state_table_size() )
+                this->states.reserve( bc->state_table_size() );
+        }
 
         void sync()
         {
@@ -126,18 +140,39 @@ struct Builder
     auto &hasher() { return _hasher; }
 
     Builder( const Builder &e ) : _d( e._d ), _hasher( e._hasher, _d.pool, _d.solver )
-    {}
+    {
+        _hasher._telemetry = _d.states.telemetry();
+    }
 
     template< typename... Args >
     Builder( BC bc, Args && ... args ) : _d( bc, args... ), _hasher( _d.pool, _d.ctx.heap(), _d.solver )
-    {}
+    {
+        _hasher._telemetry = _d.states.telemetry();
+    }
 
-    std::pair< Snapshot, bool > store( Snapshot snap )
+    /* Once saturated, the state space is no longer allowed to grow: states
+     * which are already known are handled as usual, but new ones (unless
+     * admitted explicitly) are dropped. The counter goes up for each edge
+     * into a dropped state, not once per state. Dropped states come back
+     * as a null snapshot. This is used to finish a search gracefully when
+     * running out of memory, at the cost of exhaustiveness. */
+    void saturate() { *_d.saturated = true; }
+    bool saturated() const { return *_d.saturated; }
+    int64_t dropped() const { return *_d.dropped; }
+
+    std::pair< Snapshot, bool > store( Snapshot snap, bool admit = true )
     {
         hash_timer _timer;
         _hasher.prepare( snap );
-        auto r = _d.states.insert( snap, hasher() );
-        if ( r->load() != snap )
+        admit = admit || !saturated();
+        auto r = admit ? _d.states.insert( snap, hasher() ) : _d.states.find( snap, hasher() );
+        if ( !r.valid() )
+        {
+            heap().snap_put( pool(), snap );
+            ++ *_d.dropped;
+            return { Snapshot(), false };
+        }
+        else if ( r->load() != snap )
         {
             heap().snap_put( pool(), snap );
             context().load( pool(), *r );
@@ -194,11 +229,18 @@ struct Builder
         lbl.accepting = context().flags_any( _VM_CF_Accepting );
         lbl.error = context().flags_any( _VM_CF_Error );
         lbl.interrupts = context()._interrupts;
+        lbl.task = context()._tid;
         return lbl;
     }
 
     bool equal( Snapshot a, Snapshot b ) { return hasher().equal_symbolic( a, b ); }
 
+    /* Searches which keep per-state data (liveness) allocate this many slots
+     * for each snapshot; a product with a property automaton (mc::Product)
+     * has multiple states for each snapshot. */
+    int slots() const { return 1; }
+    static int slot( builder::State ) { return 0; }
+
     bool feasible()
     {
         if ( context().flags_any( _VM_CF_Cancel ) )
@@ -237,8 +279,11 @@ struct Builder
             builder::State st;
             bool isnew;
 
-            std::tie( st.snap, isnew ) = store( snap );
-            yield( st, lbl, isnew );
+            std::tie( st.snap, isnew ) = store( snap, lbl.error );
+            if ( st.snap.slab() )
+                yield( st, lbl, isnew );
+            else /* dropped, the context must not point into a freed snapshot */
+                context().load( pool(), from.snap );
         };
 
         auto do_eval = [&]( Check &tc )
@@ -251,6 +296,10 @@ struct Builder
             } while ( cont && tc.feasible );
         };
 
+        bool cold = heap().cold( pool() );
+        if ( cold )
+            heap().cold_enter();
+
         context().track_memory( true );
         _d.solver.reset();
 
@@ -308,6 +357,7 @@ struct Builder
             }
             else
             {
+                reexec_timer _timer( brq::profiling );
                 if ( tc.feasible )
                     context().heap().snap_put( pool(), tc.snap );
                 context()._lock = tc.lock;
@@ -322,6 +372,7 @@ struct Builder
                 do_eval( tc );
                 ASSERT_EQ( tc.tid, context()._tid );
                 _d.local_instructions += context().instruction_count();
+                _timer.stop();
 
                 if ( tc.feasible )
                 {
@@ -338,6 +389,12 @@ struct Builder
                 context().finished();
             }
         }
+
+        if ( cold ) /* 'from' is now fully explored */
+        {
+            heap().freeze( pool(), from.snap );
+            heap().cold_leave();
+        }
     }
 
     template< typename Y >
@@ -23,16 +23,31 @@
 #include <divine/mc/machine.hpp>
 #include <divine/mc/weaver.hpp>
 #include <divine/vm/eval.tpp>
+#include <brick-except>
 
 #include <queue>
+#include <deque>
+#include <future>
+#include <optional>
+#include <algorithm>
+#include <condition_variable>
 
 namespace divine::mc
 {
     template< typename next >
     struct print_trace : next
     {
+        bool _mute = false; /* set while a parallel worker replays a path prefix */
+
         using next::trace;
-        void trace( std::string s ) { std::cout << s << std::endl; }
+        void trace( std::string s )
+        {
+            static std::mutex mutex;
+            if ( _mute )
+                return;
+            std::lock_guard< std::mutex > lock( mutex );
+            std::cout << s << std::endl;
+        }
         void trace( vm::TraceInfo ti ) { trace( this->heap().read_string( ti.text ) ); }
     };
 
@@ -67,38 +82,52 @@ namespace divine::mc
     template< typename next >
     using on_exit_notify_ = infeasible_notify_with_flag_< _VM_CF_Stop, next >;
 
-    struct backtrack : machine::tree_search
+    template< typename base >
+    struct backtrack_ : base
     {
-        std::stack< task::choose > _stack;
-        using machine::tree_search::run;
+        using typename base::tq;
+        using base::run;
+        std::deque< task::choose > _stack;
 
         void run( tq q, event::infeasible )
         {
             if ( !_stack.empty() )
             {
-                TRACE( "encountered an infeasible path, backtracking at", _stack.top() );
-                reply( q, _stack.top() );
-                _stack.pop();
+                TRACE( "encountered an infeasible path, backtracking at", _stack.back() );
+                auto c = _stack.back();
+                _stack.pop_back();
+                this->resume( q, c );
             }
         }
 
         void run( tq q, task::choose c )
         {
             if ( c.choice )
-                _stack.push( c );
+                _stack.push_back( c );
             else
-                reply( q, c );
+                this->resume( q, c );
         }
 
-        ~backtrack()
+        /* the shallowest choice left, i.e. the biggest subtree */
+        size_t pending() const { return _stack.size(); }
+        task::choose steal()
+        {
+            auto c = _stack.front();
+            _stack.pop_front();
+            return c;
+        }
+
+        ~backtrack_()
         {
             /* FIXME
             while ( !_stack.empty() )
-                this->snap_put( _stack.top().snap ), _stack.pop();
+                this->snap_put( _stack.back().snap ), _stack.pop_back();
             */
         }
     };
 
+    using backtrack = backtrack_< machine::tree_search >;
+
     template< typename value_t, typename heuristic_t >
     using priority_queue = std::priority_queue< value_t, std::vector< value_t >, heuristic_t >;
 
@@ -131,6 +160,7 @@ namespace divine::mc
         }
 
         bool empty() const noexcept { return _queue.empty(); }
+        size_t size() const noexcept { return _queue.size(); }
     };
 
     struct coverage_heuristic
@@ -140,6 +170,7 @@ namespace divine::mc
 
         std::unordered_map< choice_id, task_pool_t > _pools;
         std::unordered_map< choice_id, int > _counters;
+        size_t _size = 0;
 
         int top_id() noexcept
         {
@@ -158,6 +189,7 @@ namespace divine::mc
             if ( !_counters.count( id ) )
                 _counters[ id ] = 0;
             _pools[ id ].push( std::move( c ) );
+            ++ _size;
         }
 
         task::choose pop_task( task_pool_t & pool ) noexcept
@@ -174,27 +206,30 @@ namespace divine::mc
 
             auto & pool = _pools[ id ];
             auto task = pop_task( pool );
+            -- _size;
             if ( pool.empty() )
                 _pools.erase( id );
             return task;
         }
 
         bool empty() const noexcept { return _pools.empty(); }
+        size_t size() const noexcept { return _size; }
     };
 
-    template< typename heuristic_t >
-    struct heuristic_search : machine::tree_search
+    template< typename heuristic_t, typename base = machine::tree_search >
+    struct heuristic_search : base
     {
+        using typename base::tq;
         heuristic_t _queue;
 
-        using machine::tree_search::run;
+        using base::run;
 
         void run( tq q, event::infeasible )
         {
             if ( !_queue.empty() )
             {
                 TRACE( "encountered an infeasible path, backtracking at", _queue.top() );
-                reply( q, _queue.pop() );
+                this->resume( q, _queue.pop() );
             }
         }
 
@@ -205,8 +240,188 @@ namespace divine::mc
 
             if ( last_choice ) {
                 TRACE( "heuristic choose continue at", _queue.top() );
-                reply( q, _queue.pop() );
+                this->resume( q, _queue.pop() );
+            }
+        }
+
+        /* donate the most promising choice: the point is to spread the
+         * search over the best candidates, not to keep them all local */
+        size_t pending() const { return _queue.size(); }
+        task::choose steal() { return _queue.pop(); }
+    };
+
+    /*
+     * Parallel exhaustive execution. Each worker owns a complete, independent
+     * copy of the machine pipeline (computer, heap, snapshot pool) and runs one
+     * of the sequential tactics above. Since snapshots cannot be shared between
+     * workers, work is handed over as a path: the sequence of choices (the
+     * values returned by __vm_choose) that leads from the initial state to an
+     * unexplored alternative. The receiving worker starts from scratch,
+     * replays the prefix with its output muted and continues with its own
+     * search from there. A worker that hits the end of a path donates its
+     * shallowest (or most promising) pending choices while others are idle.
+     */
+
+    struct parallel_frontier
+    {
+        using path = std::vector< int >;
+
+        std::mutex _mutex;
+        std::condition_variable _cond;
+        std::deque< path > _paths;
+        int _threads, _idle = 0;
+        std::atomic< int > _hungry;
+        bool _failed = false;
+
+        parallel_frontier( int threads ) : _threads( threads ), _hungry( 0 )
+        {
+            _paths.emplace_back(); /* the empty path: start at the initial state */
+        }
+
+        bool hungry() const { return _hungry.load( std::memory_order_relaxed ) > 0; }
+
+        void push( path p )
+        {
+            std::lock_guard< std::mutex > lock( _mutex );
+            _paths.push_back( std::move( p ) );
+            _cond.notify_one();
+        }
+
+        /* blocks until a path is available; nullopt once all workers are idle
+         * at the same time (the search is finished) or a worker failed */
+        std::optional< path > pop()
+        {
+            std::unique_lock< std::mutex > lock( _mutex );
+            ++ _idle;
+            while ( _paths.empty() && !_failed && _idle < _threads )
+            {
+                ++ _hungry;
+                _cond.wait( lock );
+                -- _hungry;
+            }
+
+            if ( _paths.empty() || _failed )
+            {
+                _cond.notify_all();
+                return std::nullopt;
+            }
+
+            -- _idle;
+            auto p = std::move( _paths.front() );
+            _paths.pop_front();
+            return p;
+        }
+
+        void fail()
+        {
+            std::lock_guard< std::mutex > lock( _mutex );
+            _failed = true;
+            _cond.notify_all();
+        }
+    };
+
+    struct parallel_search : machine::tree_search
+    {
+        struct step : brq::refcount_base< uint16_t, true >
+        {
+            using ptr = brq::refcount_ptr< step >;
+            ptr parent;
+            int choice;
+            size_t depth; /* the number of choices on the path */
+            step( ptr p, int c ) : parent( p ), choice( c ), depth( p ? p->depth + 1 : 1 ) {}
+        };
+
+        struct point
+        {
+            step::ptr path;
+            int remaining;
+            size_t depth() const { return path ? path->depth : 0; }
+        };
+
+        std::shared_ptr< parallel_frontier > _frontier;
+        parallel_frontier::path _prefix;
+        bool *_mute = nullptr;
+
+        step::ptr _path; /* the choices taken to reach the current state */
+        std::unordered_map< uint64_t, point > _points; /* choose snapshot → its path */
+
+        /* the path through the alternative c; forgets the choice point once
+         * all of its alternatives have been accounted for */
+        step::ptr release( const task::choose &c )
+        {
+            auto i = _points.find( c.snap.intptr() );
+            ASSERT( i != _points.end() );
+            auto p = brq::make_refcount< step >( i->second.path, c.choice );
+            if ( -- i->second.remaining == 0 )
+                _points.erase( i );
+            return p;
+        }
+
+        void resume( tq q, task::choose c )
+        {
+            _path = release( c );
+            reply( q, c );
+        }
+
+        /* the alternative is explored elsewhere, let the machine release it */
+        void drop( tq q, const task::choose &c )
+        {
+            reply( q, task::drop( c.snap ) );
+        }
+
+        void donate( tq q, const task::choose &c )
+        {
+            parallel_frontier::path p;
+            for ( auto s = release( c ); s; s = s->parent )
+                p.push_back( s->choice );
+            std::reverse( p.begin(), p.end() );
+            _frontier->push( std::move( p ) );
+            drop( q, c );
+        }
+    };
+
+    template< typename tactic >
+    struct parallel : tactic
+    {
+        using typename tactic::tq;
+        using tactic::run;
+
+        parallel( std::shared_ptr< parallel_frontier > f, parallel_frontier::path p, bool *mute )
+        {
+            this->_frontier = f;
+            this->_prefix = std::move( p );
+            this->_mute = mute;
+            *mute = !this->_prefix.empty();
+        }
+
+        void run( tq q, task::choose c )
+        {
+            if ( c.choice == 0 ) /* the alternatives of a choice arrive in order */
+                this->_points[ c.snap.intptr() ] = { this->_path, c.total };
+
+            /* siblings of a replayed alternative may still arrive after it has
+             * been resumed, so they are matched by the depth of their point */
+            size_t depth = this->_points[ c.snap.intptr() ].depth();
+            if ( depth < this->_prefix.size() )
+            {
+                if ( c.choice != this->_prefix[ depth ] ) /* explored elsewhere */
+                {
+                    this->release( c );
+                    return this->drop( q, c );
+                }
+                if ( depth + 1 == this->_prefix.size() )
+                    *this->_mute = false;
+                return this->resume( q, c );
             }
+
+            tactic::run( q, c );
+        }
+
+        void run( tq q, event::infeasible e )
+        {
+            while ( this->pending() > 1 && this->_frontier->hungry() )
+                this->donate( q, this->steal() );
+            tactic::run( q, e );
         }
     };
 
@@ -215,7 +430,7 @@ namespace divine::mc
     using queue_exec = task_queue< event::infeasible >;
 
     template< typename solver_t >
-    struct mach_exec : brq::compose_stack< infeasible_notify, machine::compute,
+    struct mach_exec : brq::compose_stack< infeasible_notify, machine::fork_choice, machine::compute,
                                            machine::with_context< ctx_exec >,
                                            machine::base< solver_t, queue_exec > > {};
 
@@ -227,6 +442,23 @@ namespace divine::mc
     using weighted = weight_comparator< task::choose >;
     using closest_fault_search = heuristic_search< distance_heuristic< weighted > >;
 
+    using parallel_backtrack = parallel< backtrack_< parallel_search > >;
+    using parallel_coverage = parallel< heuristic_search< coverage_heuristic, parallel_search > >;
+    using parallel_closest_fault =
+        parallel< heuristic_search< distance_heuristic< weighted >, parallel_search > >;
+
+    static void merge( brick::mem::Stats &to, const brick::mem::Stats &from )
+    {
+        for ( auto &i : from )
+        {
+            auto &t = to[ i.size ];
+            t.bytes += i.bytes;
+            t.count += i.count;
+        }
+        to.total.bytes += from.total.bytes;
+        to.total.count += from.total.count;
+    }
+
     template< typename solver_t, template< typename > typename exec_t, typename tactic_t >
     void Exec::do_run()
     {
@@ -240,9 +472,55 @@ namespace divine::mc
         _ps[ "fragment memory" ] = c.context().heap().mem_stats();
     }
 
+    template< typename solver_t, template< typename > typename exec_t, typename tactic_t >
+    void Exec::do_run_parallel( int threads )
+    {
+        auto frontier = std::make_shared< parallel_frontier >( threads );
+        std::mutex mutex;
+        std::exception_ptr error;
+
+        auto worker = [&]
+        {
+            try
+            {
+                while ( auto path = frontier->pop() )
+                {
+                    exec_t< solver_t > c;
+                    c.bc( _bc );
+                    c.context().enable_debug();
+                    tactic_t b( frontier, std::move( *path ), &c.context()._mute );
+                    weave( c, b ).start();
+
+                    std::lock_guard< std::mutex > lock( mutex );
+                    merge( _ps[ "snapshot memory" ], c._state_pool.stats() );
+                    merge( _ps[ "fragment memory" ], c.context().heap().mem_stats() );
+                }
+            }
+            catch ( ... )
+            {
+                std::lock_guard< std::mutex > lock( mutex );
+                if ( !error )
+                    error = std::current_exception();
+                frontier->fail();
+            }
+        };
+
+        std::vector< std::future< void > > workers;
+        for ( int i = 0; i < threads; ++i )
+            workers.push_back( std::async( std::launch::async, worker ) );
+        for ( auto &w : workers )
+            w.get();
+
+        if ( error )
+            std::rethrow_exception( error );
+    }
+
     // This is ugly and we don't want it here...
-    void Exec::run( bool exhaustive, std::string_view tactic )
+    void Exec::run( bool exhaustive, std::string_view tactic, int threads )
     {
+        if ( exhaustive && threads > 1 )
+            return run_parallel( tactic, threads );
+
         if ( _bc->is_symbolic() )
         {
             if ( exhaustive && tactic == "none" )
@@ -273,6 +551,33 @@ namespace divine::mc
             if ( !exhaustive && tactic == "fault" )
                 return do_run< smt::NoSolver, mach_exec, closest_fault_search >();
         }
+
+        throw brq::error( "unknown tactic '" + std::string( tactic ) + "', expected none, "
+                          "coverage or fault" );
     }
-}
 
+    void Exec::run_parallel( std::string_view tactic, int threads )
+    {
+        if ( _bc->is_symbolic() )
+        {
+            if ( tactic == "none" )
+                return do_run_parallel< smt::STPSolver, exhaustive_exec, parallel_backtrack >( threads );
+            if ( tactic == "coverage" )
+                return do_run_parallel< smt::STPSolver, exhaustive_exec, parallel_coverage >( threads );
+            if ( tactic == "fault" )
+                return do_run_parallel< smt::STPSolver, exhaustive_exec, parallel_closest_fault >( threads );
+        }
+        else
+        {
+            if ( tactic == "none" )
+                return do_run_parallel< smt::NoSolver, exhaustive_exec, parallel_backtrack >( threads );
+            if ( tactic == "coverage" )
+                return do_run_parallel< smt::NoSolver, exhaustive_exec, parallel_coverage >( threads );
+            if ( tactic == "fault" )
+                return do_run_parallel< smt::NoSolver, exhaustive_exec, parallel_closest_fault >( threads );
+        }
+
+        throw brq::error( "unknown tactic '" + std::string( tactic ) + "', expected none, "
+                          "coverage or fault" );
+    }
+}
@@ -84,7 +84,11 @@ struct Exec
 
     template< typename solver_t, template< typename > typename exec_t, typename tactic_t >
     void do_run();
-    void run( bool exhaustive, std::string_view tactic = "none" );
+    template< typename solver_t, template< typename > typename exec_t, typename tactic_t >
+    void do_run_parallel( int threads );
+
+    void run( bool exhaustive, std::string_view tactic = "none", int threads = 1 );
+    void run_parallel( std::string_view tactic, int threads );
 
     void trace();
 
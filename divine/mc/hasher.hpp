@@ -18,6 +18,7 @@
 
 #pragma once
 #include <divine/smt/solver.hpp>
+#include <divine/mc/types.hpp>
 
 namespace divine::mc::impl
 {
@@ -52,6 +53,7 @@ namespace divine::mc::impl
         mutable vm::CowHeap _h1, _h2;
         vm::HeapPointer _root, _path;
         bool overwrite = false;
+        brq::hash_set_telemetry *_telemetry = nullptr; /* of the table we serve, if any */
 
         void attach( const vm::CowHeap &heap )
         {
@@ -73,18 +75,21 @@ namespace divine::mc::impl
             _root = o._root;
             _path = o._path;
             overwrite = o.overwrite;
+            _telemetry = o._telemetry;
         }
 
         void prepare( Snapshot ) {}
 
+        grow_timer rehashing() const { return grow_timer( brq::profiling ); }
+
         bool equal_fastpath( Snapshot a, Snapshot b ) const
         {
-            bool rv = false;
-            if ( _pool.size( a ) == _pool.size( b ) )
-                rv = std::equal( _h1.snap_begin( _pool, a ), _h1.snap_end( _pool, a ),
-                                 _h1.snap_begin( _pool, b ) );
+            bool rv = _h1.snap_equal( _pool, a, b );
             if ( !rv )
                 _h1.restore( _pool, a ), _h2.restore( _pool, b );
+            if ( _telemetry )
+                _telemetry->bump( rv ? brq::hash_set_telemetry::FastCompare
+                                     : brq::hash_set_telemetry::SlowCompare );
             return rv;
         }
 
@@ -0,0 +1,121 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+
+/*
+ * (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <divine/mc/heuristic.hpp>
+#include <divine/mc/bitcode.hpp>
+#include <divine/vm/program.hpp>
+
+DIVINE_RELAX_WARNINGS
+#include <llvm/IR/Module.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/CallSite.h>
+DIVINE_UNRELAX_WARNINGS
+
+#include <brick-except>
+
+#include <deque>
+#include <map>
+#include <set>
+
+namespace divine::mc
+{
+
+static const std::set< std::string > fault_functions = { "__dios_fault", "__assert_fail", "abort" };
+
+/* A multi-source BFS over the reversed graph of basic blocks, starting from
+ * those which call a fault function. A block can reach a fault through its
+ * successors, or by calling a function whose entry block can. Returns from
+ * functions are not followed, the distance is only an estimate anyway. */
+
+static std::map< llvm::BasicBlock *, int > fault_distance( llvm::Module &m )
+{
+    std::map< llvm::BasicBlock *, int > dist;
+    std::map< llvm::Function *, std::vector< llvm::BasicBlock * > > callers;
+    std::deque< llvm::BasicBlock * > queue;
+
+    auto reach = [&]( llvm::BasicBlock *bb, int d )
+    {
+        if ( dist.emplace( bb, d ).second )
+            queue.push_back( bb );
+    };
+
+    for ( auto &F : m )
+        for ( auto &BB : F )
+            for ( auto &I : BB )
+            {
+                llvm::CallSite cs( &I );
+                if ( !cs )
+                    continue;
+                auto callee = cs.getCalledFunction();
+                if ( !callee )
+                    continue;
+                if ( fault_functions.count( callee->getName().str() ) )
+                    reach( &BB, 0 );
+                else
+                    callers[ callee ].push_back( &BB );
+            }
+
+    while ( !queue.empty() )
+    {
+        auto bb = queue.front();
+        queue.pop_front();
+        int d = dist[ bb ] + 1;
+
+        for ( auto pred : llvm::predecessors( bb ) )
+            reach( pred, d );
+
+        auto fn = bb->getParent();
+        if ( bb == &fn->getEntryBlock() )
+            for ( auto caller : callers[ fn ] )
+                reach( caller, d );
+    }
+
+    return dist;
+}
+
+Heuristic::Heuristic( std::string spec, BitCode &bc )
+{
+    for ( auto s : brq::splitter( spec, ',' ) )
+        if ( s == "fault" )
+            _fault = true;
+        else if ( s == "trace" )
+            _trace = true;
+        else
+            throw brq::error( "unknown heuristic '" + std::string( s ) + "', expected fault or trace" );
+
+    if ( !_fault )
+        return;
+
+    /* each basic block starts with an OpBB, followed by one slot for each
+     * of its instructions (cf. xg::AddressMap::code) */
+    auto &program = bc.program();
+    auto dist = fault_distance( *bc._module );
+    _distance = std::make_shared< std::vector< std::vector< int > > >( program.functions.size() );
+
+    for ( auto [ bb, pc ] : program._addr._code )
+    {
+        auto &fd = ( *_distance )[ pc.function() ];
+        fd.resize( program.function( pc ).instructions.size(), far );
+        auto d = dist.count( bb ) ? dist[ bb ] : far;
+
+        for ( int i = 0; i <= int( bb->size() ) && pc.instruction() < fd.size(); ++i, pc = pc + 1 )
+            fd[ pc.instruction() ] = d;
+    }
+}
+
+}
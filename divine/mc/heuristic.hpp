@@ -0,0 +1,89 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+
+/*
+ * (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <divine/vm/pointer.hpp>
+#include <brick-string>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdlib>
+
+namespace divine::mc
+{
+
+struct BitCode;
+
+/*
+ * Scores the edges of the state space for a best-first search (see
+ * ss::Order::BestFirst), higher scores are explored first. Two sources of
+ * information can be combined:
+ *
+ *  - 'fault': the static distance from the location where the edge stopped
+ *    (the last interrupt) to the nearest call of a fault function, counted
+ *    in basic blocks along the control flow graph and into callees,
+ *  - 'trace': user-supplied scores, emitted by the program itself using
+ *    __vm_trace( _VM_T_Text, "priority: N" ); these are summed up.
+ *
+ * Edges which end in an error always come first.
+ */
+
+struct Heuristic
+{
+    static constexpr int far = 1 << 20; /* no fault reachable */
+
+    bool _fault = false, _trace = false;
+    std::shared_ptr< std::vector< std::vector< int > > > _distance; /* [ function ][ instruction ] */
+
+    Heuristic() = default;
+    Heuristic( std::string spec, BitCode &bc );
+
+    explicit operator bool() const { return _fault || _trace; }
+
+    int distance( vm::CodePointer pc ) const
+    {
+        if ( !_distance || pc.function() >= _distance->size() )
+            return far;
+        auto &f = ( *_distance )[ pc.function() ];
+        return pc.instruction() < f.size() ? f[ pc.instruction() ] : far;
+    }
+
+    template< typename Label >
+    int64_t operator()( const Label &l ) const
+    {
+        int64_t score = 0;
+
+        if ( l.error )
+            return std::numeric_limits< int64_t >::max();
+
+        if ( _fault )
+            score -= l.interrupts.empty() ? far : distance( l.interrupts.back().pc );
+
+        if ( _trace )
+            for ( auto &t : l.trace )
+                if ( brq::starts_with( t, "priority: " ) )
+                    score += std::atoll( t.c_str() + 10 );
+
+        return score;
+    }
+};
+
+}
@@ -23,12 +23,20 @@
 #include <divine/vm/program.hpp>
 #include <divine/mc/trace.hpp>
 #include <divine/mc/types.hpp>
+#include <divine/mc/heuristic.hpp>
 #include <brick-mem>
 #include <brick-shmem>
 
 namespace divine::mc
 {
 
+/* How liveness checking treats the tasks of the program: either the program
+ * (i.e. the 'fair' DiOS configuration) takes care of fairness by itself, or
+ * only cycles which are weakly or strongly fair are counterexamples. */
+enum class Fairness { Program, Weak, Strong };
+
+struct Property;
+
 struct Job : ss::Job
 {
     std::shared_ptr< brick::shmem::ThreadBase > _monitor_loop;
@@ -36,6 +44,7 @@ struct Job : ss::Job
     std::function< std::pair< int64_t, int64_t >() > stats = []() { return std::make_pair( 0, 0 ); };
     std::function< int64_t() > queuesize = []() { return 0; };
     std::shared_ptr< ss::Job > _search;
+    ss::Order _order = ss::Order::PseudoBFS; /* if the job is free to choose */
 
     template< typename Monitor >
     void start( int threads, Monitor monit )
@@ -44,6 +53,24 @@ struct Job : ss::Job
         _monitor = monit;
     }
 
+    Heuristic _heuristic;
+
+    /* Errors for which the filter returns true are not counterexamples: the
+     * search does not stop there and does not continue past them either.
+     * The filter gets the state the error edge starts in and the step taken
+     * along the edge; it is called from the search threads. */
+    using ErrorFilter = std::function< bool( vm::CowSnapshot, const vm::Step & ) >;
+    ErrorFilter _error_filter;
+
+    void error_filter( ErrorFilter f ) { _error_filter = f; }
+    Fairness _fairness = Fairness::Program;
+    std::shared_ptr< const Property > _property; /* checked in the product, if set */
+
+    void fairness( Fairness f ) { _fairness = f; }
+    void property( std::shared_ptr< const Property > p ) { _property = p; }
+    void order( ss::Order o ) { _order = o; }
+    void heuristic( Heuristic h ) { _heuristic = h; _order = ss::Order::BestFirst; }
+
     void wait() override
     {
         auto clock = std::chrono::steady_clock::now();
@@ -70,6 +97,8 @@ struct Job : ss::Job
     virtual Result result() { return Result::None; }
     virtual PoolStats poolstats() { return PoolStats(); }
     virtual HashStats hashstats() { return HashStats(); }
+    virtual void saturate() {} /* stop growing the state space, if supported */
+    virtual int64_t dropped() { return 0; } /* edges cut off by saturate() */
     virtual void dbg_fill( DbgCtx & ) {}
     virtual void start( int ) override = 0;
     virtual ~Job() = default;
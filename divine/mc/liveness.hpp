@@ -22,8 +22,14 @@
 #include <divine/mc/job.hpp>
 #include <divine/mc/builder.hpp>
 #include <divine/mc/trace.hpp>
+#include <divine/mc/product.hpp>
 #include <brick-query>
 
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+
 namespace divine {
 namespace mc {
 
@@ -91,10 +97,17 @@ struct NestedDFS : ss::Job
 
     auto init_state( State &s )
     {
-        _flagPool.materialise( s.snap, sizeof( StateFlags ) );
-        new ( _flagPool.machinePointer< StateFlags >( s.snap ) ) StateFlags();
+        _flagPool.materialise( s.snap, sizeof( StateFlags ) * _builder.slots() );
+        auto flags = _flagPool.machinePointer< StateFlags >( s.snap );
+        for ( int i = 0; i < _builder.slots(); ++i )
+            new ( flags + i ) StateFlags();
     };
 
+    StateFlags &flags( State s )
+    {
+        return _flagPool.machinePointer< StateFlags >( s.snap )[ _builder.slot( s ) ];
+    }
+
     bool outer( State from )
     {
         outer_stack.emplace_back( from );
@@ -103,7 +116,7 @@ struct NestedDFS : ss::Job
         while ( !outer_stack.empty() )
         {
             const auto item = outer_stack.back();
-            auto &flags = *_flagPool.machinePointer< StateFlags >( item.state.snap );
+            auto &flags = this->flags( item.state );
 
             if ( item.type == StackItemType::DfsStack ) // backtracking
             {
@@ -165,7 +178,7 @@ struct NestedDFS : ss::Job
         while ( !inner_stack.empty() )
         {
             auto &item = inner_stack.back();
-            auto &flags = *_flagPool.machinePointer< StateFlags >( item.state.snap );
+            auto &flags = this->flags( item.state );
 
             if ( item.type == StackItemType::DfsStack ) // backtracking
                 inner_stack.pop_back();
@@ -233,15 +246,463 @@ struct NestedDFS : ss::Job
     void stop() override {}
 };
 
+/*
+ * Fair cycle detection. Instead of having the program keep track of fairness
+ * in its own state (the 'fair' DiOS configuration, which multiplies the size
+ * of the state space), we only accept cycles which are fair towards the tasks
+ * of the program. Each edge is labelled with the task that ran along it (as
+ * reported by the scheduler through _VM_T_TaskID), and a task is enabled in a
+ * state if it labels an edge from that state. A cycle is weakly fair if each
+ * task enabled in all of its states also runs on it, and strongly fair if
+ * each task enabled in any of its states runs on it.
+ *
+ * The state space is first split into strongly connected components (using
+ * Tarjan's algorithm). Components with an accepting edge are then expanded
+ * once more into an explicit graph and checked: a weakly fair accepting cycle
+ * exists iff each task enabled throughout the component runs within it.
+ * Under strong fairness, the states which enable a task that never runs in
+ * the component are removed and the rest is decomposed again, as in the
+ * Emerson-Lei algorithm.
+ */
+
+template< typename Builder >
+struct FairSCC : ss::Job
+{
+    using State = typename Builder::State;
+    using Label = typename Builder::Label;
+    using MasterPool = typename vm::CowHeap::SnapPool;
+    using SlavePool = brick::mem::SlavePool< MasterPool >;
+    using Task = vm::GenericPointer;
+    using Tasks = std::set< Task >;
+
+    Builder _builder;
+    SlavePool _flagPool;
+    Fairness _fairness;
+    std::atomic< bool > _stop = false;
+
+    struct StateFlags
+    {
+        uint32_t index = 0, low = 0;
+        bool on_stack:1 = false;
+        bool accepting:1 = false; /* an accepting edge starts here */
+        bool loop:1 = false;
+    };
+
+    struct Frame
+    {
+        State state;
+        std::vector< State > succs;
+        size_t next = 0;
+    };
+
+    std::vector< Frame > _dfs;  /* the path from the initial state */
+    std::vector< State > _scc;  /* Tarjan's stack */
+    uint32_t _index = 0;
+
+    struct Edge { int to; bool accepting; Task task; };
+    struct Node
+    {
+        State state;
+        std::vector< Edge > out;
+        Tasks enabled;
+    };
+
+    using Graph = std::vector< Node >;
+    using Component = std::vector< int >;
+
+    /* the counterexample: the search stack leading to _goal (either an
+     * error state, or the root of a component with a fair accepting cycle);
+     * in the latter case followed by a path through _graph, given as (state,
+     * index of the outgoing edge) pairs which ends in a cycle */
+    std::vector< State > _prefix;
+    std::optional< State > _goal;
+    Graph _graph;
+    std::vector< std::pair< int, int > > _steps;
+
+    FairSCC( Builder builder, Fairness f ) :
+        _builder( builder ), _flagPool( _builder.pool() ), _fairness( f )
+    {}
+
+    StateFlags &flags( State s )
+    {
+        return _flagPool.machinePointer< StateFlags >( s.snap )[ _builder.slot( s ) ];
+    }
+
+    void init_state( State s )
+    {
+        _flagPool.materialise( s.snap, sizeof( StateFlags ) * _builder.slots() );
+        auto flags = _flagPool.machinePointer< StateFlags >( s.snap );
+        for ( int i = 0; i < _builder.slots(); ++i )
+            new ( flags + i ) StateFlags();
+    }
+
+    void push( State s )
+    {
+        auto &f = flags( s );
+        f.index = f.low = ++_index;
+        f.on_stack = true;
+        _scc.push_back( s );
+        _dfs.emplace_back();
+        _dfs.back().state = s;
+
+        _builder.edges( s, [&]( State to, const Label &l, bool isnew )
+            {
+                if ( isnew )
+                    init_state( to );
+                if ( l.error && !_goal )
+                {
+                    for ( auto &fr : _dfs )
+                        _prefix.push_back( fr.state );
+                    _goal = to;
+                }
+                if ( l.accepting )
+                    flags( s ).accepting = true;
+                if ( to == s )
+                    flags( s ).loop = true;
+                _dfs.back().succs.push_back( to );
+            } );
+        _builder._d.sync();
+    }
+
+    void search( State initial )
+    {
+        init_state( initial );
+        push( initial );
+
+        while ( !_dfs.empty() && !_goal && !_stop )
+        {
+            auto &top = _dfs.back();
+
+            if ( top.next < top.succs.size() )
+            {
+                State to = top.succs[ top.next++ ];
+                auto &t = flags( to );
+                if ( !t.index )
+                    push( to );
+                else if ( t.on_stack )
+                    flags( top.state ).low = std::min( flags( top.state ).low, t.index );
+                continue;
+            }
+
+            State s = top.state;
+            _dfs.pop_back();
+            auto &f = flags( s );
+
+            if ( !_dfs.empty() )
+            {
+                auto &p = flags( _dfs.back().state );
+                p.low = std::min( p.low, f.low );
+            }
+
+            if ( f.low == f.index )
+                component( s );
+        }
+    }
+
+    void component( State root )
+    {
+        std::vector< State > states;
+        bool accepting = false;
+        State s;
+
+        do {
+            s = _scc.back();
+            _scc.pop_back();
+            flags( s ).on_stack = false;
+            accepting = accepting || flags( s ).accepting;
+            states.push_back( s );
+        } while ( !( s == root ) );
+
+        if ( !accepting || ( states.size() == 1 && !flags( root ).loop ) )
+            return;
+
+        Graph g( states.size() );
+        std::map< std::pair< uintptr_t, int >, int > index;
+        auto key = [&]( State s ) { return std::pair( s.snap.intptr(), _builder.slot( s ) ); };
+
+        for ( size_t i = 0; i < states.size(); ++i )
+            g[ i ].state = states[ i ], index[ key( states[ i ] ) ] = i;
+
+        for ( auto &n : g )
+        {
+            _builder.edges( n.state, [&]( State to, const Label &l, bool )
+                {
+                    auto i = index.find( key( to ) );
+                    n.out.push_back( { i == index.end() ? -1 : i->second, l.accepting, l.task } );
+                    if ( !l.task.null() )
+                        n.enabled.insert( l.task );
+                } );
+            _builder._d.sync();
+        }
+
+        std::vector< bool > all( g.size(), true );
+        auto c = fair( g, all );
+        if ( c.empty() )
+            return;
+
+        for ( auto &fr : _dfs )
+            _prefix.push_back( fr.state );
+        _graph = std::move( g );
+        lasso( index[ key( root ) ], c );
+        _goal = root;
+    }
+
+    /* the strongly connected components of g restricted to 'sub' */
+    static std::vector< Component > components( const Graph &g, const std::vector< bool > &sub )
+    {
+        std::vector< Component > result;
+        std::vector< int > index( g.size(), 0 ), low( g.size(), 0 ), stack;
+        std::vector< bool > on_stack( g.size(), false );
+        std::vector< std::pair< int, size_t > > dfs;
+        int counter = 0;
+
+        auto push = [&]( int n )
+        {
+            index[ n ] = low[ n ] = ++counter;
+            stack.push_back( n ), on_stack[ n ] = true;
+            dfs.emplace_back( n, 0 );
+        };
+
+        for ( size_t r = 0; r < g.size(); ++r )
+        {
+            if ( !sub[ r ] || index[ r ] )
+                continue;
+            push( r );
+
+            while ( !dfs.empty() )
+            {
+                auto &[ n, next ] = dfs.back();
+                if ( next < g[ n ].out.size() )
+                {
+                    int to = g[ n ].out[ next++ ].to;
+                    if ( to < 0 || !sub[ to ] )
+                        continue;
+                    if ( !index[ to ] )
+                        push( to );
+                    else if ( on_stack[ to ] )
+                        low[ n ] = std::min( low[ n ], index[ to ] );
+                    continue;
+                }
+
+                int done = n;
+                dfs.pop_back();
+                if ( !dfs.empty() )
+                    low[ dfs.back().first ] = std::min( low[ dfs.back().first ], low[ done ] );
+
+                if ( low[ done ] == index[ done ] )
+                {
+                    auto &c = result.emplace_back();
+                    int m;
+                    do {
+                        m = stack.back(), stack.pop_back();
+                        on_stack[ m ] = false;
+                        c.push_back( m );
+                    } while ( m != done );
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /* a component of g within 'sub' which contains a fair accepting cycle */
+    Component fair( const Graph &g, const std::vector< bool > &sub )
+    {
+        for ( auto &c : components( g, sub ) )
+        {
+            std::vector< bool > in( g.size(), false );
+            for ( int n : c )
+                in[ n ] = true;
+
+            bool accepting = false, cycle = false;
+            Tasks ran, always = g[ c.front() ].enabled, ever;
+
+            for ( int n : c )
+            {
+                for ( auto &e : g[ n ].out )
+                    if ( e.to >= 0 && in[ e.to ] )
+                    {
+                        cycle = true;
+                        accepting = accepting || e.accepting;
+                        if ( !e.task.null() )
+                            ran.insert( e.task );
+                    }
+
+                Tasks both;
+                std::set_intersection( always.begin(), always.end(),
+                                       g[ n ].enabled.begin(), g[ n ].enabled.end(),
+                                       std::inserter( both, both.begin() ) );
+                always = both;
+                ever.insert( g[ n ].enabled.begin(), g[ n ].enabled.end() );
+            }
+
+            if ( !cycle || !accepting )
+                continue;
+
+            Tasks starved;
+            for ( auto t : _fairness == Fairness::Strong ? ever : always )
+                if ( !ran.count( t ) )
+                    starved.insert( t );
+
+            if ( starved.empty() )
+                return c;
+
+            if ( _fairness == Fairness::Strong )
+            {
+                for ( int n : c )
+                    for ( auto t : g[ n ].enabled )
+                        if ( starved.count( t ) )
+                            in[ n ] = false;
+                if ( auto r = fair( g, in ); !r.empty() )
+                    return r;
+            }
+        }
+
+        return {};
+    }
+
+    /* Build a lasso through the fair component c, starting with a path from
+     * the root of the enclosing component. The cycle passes through each
+     * state of c, an accepting edge and an edge of each task which runs in c,
+     * which makes it both accepting and fair. */
+    void lasso( int root, const Component &c )
+    {
+        std::vector< bool > in( _graph.size(), false ), everywhere( _graph.size(), true );
+        std::vector< bool > seen( _graph.size(), false );
+        int at = root;
+
+        for ( int n : c )
+            in[ n ] = true;
+
+        auto step = [&]( int from, int i )
+        {
+            _steps.emplace_back( from, i );
+            at = _graph[ from ].out[ i ].to;
+            seen[ at ] = true;
+        };
+
+        auto go = [&]( int to, const std::vector< bool > &within ) /* a shortest path */
+        {
+            std::vector< std::pair< int, int > > pred( _graph.size(), { -1, -1 } ), path;
+            std::deque< int > queue{ at };
+            pred[ at ] = { at, -1 };
+
+            while ( !queue.empty() && pred[ to ].first < 0 )
+            {
+                int n = queue.front();
+                queue.pop_front();
+                for ( int i = 0; i < int( _graph[ n ].out.size() ); ++i )
+                    if ( int m = _graph[ n ].out[ i ].to; m >= 0 && within[ m ] && pred[ m ].first < 0 )
+                        pred[ m ] = { n, i }, queue.push_back( m );
+            }
+
+            for ( int n = to; n != at; n = pred[ n ].first )
+                path.push_back( pred[ n ] );
+            for ( auto it = path.rbegin(); it != path.rend(); ++it )
+                step( it->first, it->second );
+        };
+
+        int start = c.front();
+        go( start, everywhere );
+
+        bool accepting = false;
+        Tasks ran;
+
+        for ( int n : c )
+            for ( int i = 0; i < int( _graph[ n ].out.size() ); ++i )
+            {
+                auto &e = _graph[ n ].out[ i ];
+                if ( e.to < 0 || !in[ e.to ] )
+                    continue;
+                if ( ( !accepting && e.accepting ) || ( !e.task.null() && !ran.count( e.task ) ) )
+                {
+                    go( n, in );
+                    step( n, i );
+                    accepting = accepting || e.accepting;
+                    if ( !e.task.null() )
+                        ran.insert( e.task );
+                }
+            }
+
+        for ( int n : c )
+            if ( !seen[ n ] )
+                go( n, in );
+
+        go( start, in );
+    }
+
+    using StateTrace = mc::StateTrace< Builder >;
+
+    /* the label of the first edge from 'from' which satisfies match( index, to ) */
+    template< typename Match >
+    std::optional< Label > label( State from, Match match )
+    {
+        std::optional< Label > rv;
+        int k = 0;
+        _builder.edges( from, [&]( State to, const Label &l, bool )
+            {
+                if ( !rv && match( k++, to ) )
+                    rv = l;
+            } );
+        _builder._d.sync();
+        return rv;
+    }
+
+    StateTrace trace()
+    {
+        StateTrace trace;
+        std::vector< State > stem = _prefix;
+        stem.push_back( *_goal );
+
+        trace.emplace_back( stem[ 0 ].snap, std::nullopt );
+        for ( size_t i = 1; i < stem.size(); ++i )
+            trace.emplace_back( stem[ i ].snap,
+                                label( stem[ i - 1 ], [&]( int, State to ) { return to == stem[ i ]; } ) );
+
+        for ( auto [ from, i ] : _steps )
+            trace.emplace_back( _graph[ _graph[ from ].out[ i ].to ].state.snap,
+                                label( _graph[ from ].state, [&]( int k, State ) { return k == i; } ) );
+
+        return trace;
+    }
+
+    void run()
+    {
+        _builder.initials( [this] ( State state )
+            {
+                if ( !_goal )
+                    search( state );
+            } );
+    }
+
+    std::future< void > _thread;
+
+    void start( int thread_count ) override
+    {
+        if ( thread_count != 1 )
+            throw std::runtime_error( "Fair cycle detection only supports one thread." );
+        _thread = std::async( [&]{ run(); } );
+    }
+
+    void wait() override
+    {
+        _thread.get();
+    }
+
+    void stop() override { _stop = true; }
+};
+
 template< typename Next, typename Builder_ = ExplicitBuilder >
 struct Liveness : Job
 {
     using Builder = Builder_;
+    using Label = typename Builder::Label;
 
     Builder _ex;
     Next _next;
     using StateTrace = mc::StateTrace< Builder >;
     std::function< StateTrace() > _get_trace;
+    std::function< Trace( StateTrace ) > _replay;
     std::function< bool() > _error_found;
 
     template< typename... Args >
@@ -254,21 +715,83 @@ struct Liveness : Job
 
     void start( int threads ) override
     {
-        auto *search = new NestedDFS( _ex );
-        _search.reset( search );
         stats = [=] { return std::pair( _ex._d.total_states->load(), _ex._d.total_instructions->load() ); };
+
+        if ( _property )
+            start_search( Product( _ex, _property ), threads );
+        else
+            start_search( _ex, threads );
+    }
+
+    /* Plain traces are replayed by comparing snapshots. In a product, the
+     * automaton states which go with a snapshot are only told apart by the
+     * labels (see mc::Product), hence each step needs one. */
+    template< typename B, typename Path >
+    static StateTrace state_trace( B &b, const Path &path )
+    {
+        StateTrace trace;
+
+        for ( auto it = path.begin(); it != path.end(); ++it )
+        {
+            std::optional< Label > label;
+            if constexpr ( !std::is_same_v< B, Builder > )
+                if ( it != path.begin() )
+                {
+                    b.edges( *std::prev( it ), [&]( auto to, const Label &l, bool )
+                        {
+                            if ( !label && to == *it )
+                                label = l;
+                        } );
+                    b._d.sync();
+                }
+            trace.emplace_back( it->snap, label );
+        }
+
+        return trace;
+    }
+
+    template< typename B >
+    void start_search( B b, int threads )
+    {
+        if constexpr ( std::is_same_v< B, Builder > )
+            _replay = [this]( StateTrace t ) { return mc::trace( _ex, t ); };
+        else /* replay in the product, so that the trace shows the accepting edges */
+            _replay = [=]( StateTrace t ) mutable { return mc::trace( b, t ); };
+
+        if ( _fairness == Fairness::Program )
+            start_ndfs( b, threads );
+        else
+            start_fair( b, threads );
+    }
+
+    template< typename B >
+    void start_fair( B b, int threads )
+    {
+        auto *search = new FairSCC( b, _fairness );
+        _search.reset( search );
+        queuesize = [=] { return search->_dfs.size(); };
+        _get_trace = [=] { return search->trace(); };
+        _error_found = [=] { return search->_goal.has_value(); };
+        search->start( threads );
+    }
+
+    template< typename B >
+    void start_ndfs( B b, int threads )
+    {
+        auto *search = new NestedDFS( b );
+        _search.reset( search );
         queuesize = [=] { return search->outer_stack.size() + search->inner_stack.size(); };
 
         _get_trace = [=]() mutable
         {
             using State = typename std::remove_reference_t< decltype( *search ) >::State;
             auto &ce = search->counterexample;
-            StateTrace trace;
+            std::deque< State > path;
 
             for ( auto &i : ce.lasso_outer_fragment )
                 if ( i.type == StackItemType::DfsStack )
-                    trace.emplace_back( i.state.snap, std::nullopt );
-            trace.emplace_back( ce.goal->snap, std::nullopt );
+                    path.emplace_back( i.state );
+            path.emplace_back( *ce.goal );
 
             auto move_to_trace = [&]( auto r, auto &stack )
             {
@@ -276,7 +799,7 @@ struct Liveness : Job
                       it != end; ++it )
                 {
                     if ( it->type == StackItemType::DfsStack )
-                        trace.emplace_front( it->state.snap, std::nullopt );
+                        path.emplace_front( it->state );
                     stack.erase( it.base() - 1, stack.end() );
                 }
                 stack.clear();
@@ -285,7 +808,7 @@ struct Liveness : Job
             move_to_trace( ce.lasso_inner_fragment, search->inner_stack );
             move_to_trace( ce.tail_fragment, search->outer_stack );
 
-            return trace;
+            return state_trace( search->_builder, path );
         };
 
         _error_found = [=]() { return search->counterexample.goal.has_value(); };
@@ -304,13 +827,22 @@ struct Liveness : Job
 
     Trace ce_trace() override
     {
-        return _error_found() ? mc::trace( _ex, _get_trace() ) : mc::Trace();
+        return _error_found() ? _replay( _get_trace() ) : mc::Trace();
     }
 
     virtual PoolStats poolstats() override
     {
-        return PoolStats{ { "snapshot memory", _ex.pool().stats() },
-                          { "fragment memory", _ex.context().heap().mem_stats() } };
+        PoolStats ps{ { "snapshot memory", _ex.pool().stats() },
+                      { "fragment memory", _ex.context().heap().mem_stats() } };
+        if ( _ex.heap().cold( _ex.pool() ) )
+            ps.emplace( "cold memory", _ex.heap().cold_stats() );
+        return ps;
+    }
+
+    virtual HashStats hashstats() override
+    {
+        return HashStats{ { "snapshot table", _ex._d.states.stats() },
+                          { "fragment table", _ex.context().heap().ht_stats() } };
     }
 };
 
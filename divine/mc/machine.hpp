@@ -152,6 +152,7 @@ namespace divine::mc::task
     struct check_loop  : with_state  { using with_state::with_state; };
     struct schedule    : with_snap   { using with_snap::with_snap; };
     struct compute     : with_state  { using with_state::with_state; };
+    struct drop        : with_snap   { using with_snap::with_snap; }; /* an unexplored choose */
 
     struct choose : with_state
     {
@@ -274,7 +275,7 @@ namespace divine::mc::machine
         using Eval = vm::Eval< context_t >;
         using next::context;
 
-        void eval_choice( tq q, task::origin o )
+        virtual void eval_choice( tq q, task::origin o )
         {
             auto snap = context().snapshot( this->_snap_pool );
             auto state = context()._state;
@@ -335,7 +336,8 @@ namespace divine::mc::machine
             this->_snap_refcnt.put( s, destroy );
         }
 
-        void compute( tq q, task::origin o, Snapshot cont_from = Snapshot() )
+        /* continued: resume an interrupted __vm_choose, with _choice_take set */
+        void compute( tq q, task::origin o, Snapshot cont_from = Snapshot(), bool continued = false )
         {
             auto cleanup = [&]
             {
@@ -345,7 +347,7 @@ namespace divine::mc::machine
 
             brick::types::Defer _( cleanup );
             Eval eval( this->context() );
-            bool choice = eval.run_seq( !!cont_from );
+            bool choice = eval.run_seq( continued || !!cont_from );
 
             if ( !feasible( q ) )
                 return;
@@ -399,12 +401,92 @@ namespace divine::mc::machine
                 brq::make_refcount< task::origin::choice_t >( c.origin.choice, c.choice, c.total );
             compute( q, c.origin, c.snap );
         }
+
+        void run( tq, task::drop d ) { snap_put( d.snap ); }
+    };
+
+    /* Choices without snapshots, for tree exploration (see Cow::Fork). The
+     * task::choose for each alternative refers to a fork (kept in a pool of
+     * its own) instead of a snapshot. Since the base of a fork must stay
+     * alive, this is only correct if states in the state pool are never
+     * released, which is the case in a tree search. */
+    template< typename next >
+    struct fork_choice_ : next
+    {
+        using typename next::tq;
+        using typename next::context_t;
+        using Pool = typename context_t::Heap::Pool;
+        using Fork = decltype( std::declval< typename context_t::Heap & >().fork() );
+        using Eval = vm::Eval< context_t >;
+        using next::context;
+        using next::run;
+
+        Pool _fork_pool;
+        brick::mem::RefPool< Pool, uint8_t > _fork_refcnt;
+
+        fork_choice_() : _fork_refcnt( _fork_pool ) {}
+
+        Fork &fork( Snapshot s ) { return *_fork_pool.template machinePointer< Fork >( s ); }
+
+        void eval_choice( tq q, task::origin o ) override
+        {
+            context().sync_pc();
+            auto f = _fork_pool.allocate( sizeof( Fork ) );
+            new ( &fork( f ) ) Fork( context().heap().fork() );
+            auto state = context()._state;
+
+            Eval eval( context() );
+            context()._choice_take = context()._choice_count = 0;
+            eval.refresh();
+            eval.dispatch();
+            int total = context()._choice_count;
+            int weight = context()._choice_weight;
+
+            for ( int i = 0; i < total; ++i )
+            {
+                _fork_refcnt.get( f );
+                this->reply( q, task::choose( o, f, state, i, total, weight ) );
+            }
+        }
+
+        void fork_put( Snapshot s )
+        {
+            auto destroy = [&]( auto p, int cnt )
+            {
+                if ( cnt )
+                    return false;
+                context().heap().fork_put( fork( p ) );
+                fork( p ).~Fork();
+                return true;
+            };
+
+            _fork_refcnt.put( s, destroy );
+        }
+
+        void run( tq q, task::choose c )
+        {
+            TRACE( "compute choose (fork)", c.snap, c.choice, "/", c.total );
+            bool last = _fork_refcnt.count( c.snap ) == 1;
+            context().heap().restore( fork( c.snap ), last );
+            fork_put( c.snap );
+
+            context()._state = c.state;
+            context()._choice_take = c.choice;
+            context()._choice_count = c.total;
+            context().flush_ptr2i();
+            context().load_pc();
+            c.origin.choice =
+                brq::make_refcount< task::origin::choice_t >( c.origin.choice, c.choice, c.total );
+            this->compute( q, c.origin, Snapshot(), true );
+        }
+
+        void run( tq, task::drop d ) { fork_put( d.snap ); }
     };
 
     struct tree_search : machine_base
     {
         using tq = task_queue< task::compute, task::schedule, task::boot, task::choose,
-                               task::dedup_state, event::error, event::edge >;
+                               task::drop, task::dedup_state, event::error, event::edge >;
 
         void run( tq q, task::check_loop t )  { push( q, task::compute( t.origin, t.snap, t.state ) ); }
         void run( tq q, task::start )         { push( q, task::boot() ); }
@@ -498,6 +580,7 @@ namespace divine::mc::machine
     using common = brq::compose< with_context< context >, base< solver, tq > >;
 
     using compute = brq::module< compute_ >;
+    using fork_choice = brq::module< fork_choice_ >;
 
     template< typename solver, typename tq = task_queue<> >
     using compute_stack = brq::compose_stack< compute, with_context< context >, base< solver, tq > >;
@@ -0,0 +1,69 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+
+/*
+ * (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <divine/mc/product.hpp>
+#include <divine/mc/bitcode.hpp>
+#include <divine/ltl/buchi.hpp>
+#include <divine/ltl/ltl.hpp>
+
+DIVINE_RELAX_WARNINGS
+#include <llvm/IR/Module.h>
+DIVINE_UNRELAX_WARNINGS
+
+#include <brick-except>
+
+namespace divine::mc
+{
+
+Property::Property( std::string f, BitCode &bc ) : formula( f )
+{
+    ltl::TGBA2 tgba = ltl::ltlToTGBA1( ltl::LTL::parse( formula, true ), true );
+
+    for ( auto lit : tgba.allTrivialLiterals )
+    {
+        auto name = lit->string();
+        auto var = bc._module->getNamedGlobal( name );
+        auto slot = var ? bc.program().globalmap.find( var ) : bc.program().globalmap.end();
+
+        if ( slot == bc.program().globalmap.end() )
+            throw brq::error( "atomic proposition '" + name + "' is not a global variable" );
+
+        names.push_back( name );
+        props.push_back( slot->second );
+    }
+
+    /* without acceptance sets, each infinite run of the automaton is accepting */
+    sets = std::max( tgba.nAcceptingSets, size_t( 1 ) );
+    start = tgba.start;
+    states.resize( tgba.nStates );
+
+    for ( size_t s = 0; s < tgba.states.size(); ++s )
+        for ( auto &t : tgba.states[ s ] )
+        {
+            Edge e{ int( t.target ), {}, {} };
+            for ( auto [ pos, prop ] : t.label )
+                e.guard.emplace_back( pos, prop );
+            if ( tgba.nAcceptingSets )
+                e.accepting.assign( t.accepting.begin(), t.accepting.end() );
+            else
+                e.accepting = { 0 };
+            states[ s ].push_back( e );
+        }
+}
+
+}
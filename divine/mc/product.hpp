@@ -0,0 +1,183 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+
+/*
+ * (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <divine/mc/builder.hpp>
+#include <divine/vm/program.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace divine::mc
+{
+
+struct BitCode;
+
+/*
+ * An LTL property, translated (via ltl::TGBA2) into a Büchi automaton for its
+ * negation. The atomic propositions of the formula are names of global
+ * variables of the program, and a proposition holds in a state if the
+ * variable is nonzero. The automaton has transition-based generalised
+ * acceptance, which is degeneralised in the product: each automaton state is
+ * paired with the index of the next acceptance set to visit, and a product
+ * edge is accepting when the last of the sets is visited.
+ */
+
+struct Property
+{
+    struct Edge
+    {
+        int target;
+        std::vector< std::pair< bool, int > > guard; /* polarity, proposition */
+        std::vector< int > accepting;                /* sorted */
+    };
+
+    std::string formula;
+    std::vector< std::string > names;
+    std::vector< vm::Program::Slot > props;
+    std::vector< std::vector< Edge > > states;
+    int start = 0, sets = 1;
+
+    Property( std::string formula, BitCode &bc );
+
+    int slots() const { return states.size() * sets; }
+
+    /* successors of (state, level) = slot, as ( slot, accepting ) */
+    template< typename Yield >
+    void step( int slot, const std::vector< bool > &valuation, Yield yield ) const
+    {
+        int state = slot / sets, level = slot % sets;
+
+        for ( auto &e : states[ state ] )
+        {
+            bool enabled = true;
+            for ( auto [ pos, prop ] : e.guard )
+                enabled = enabled && valuation[ prop ] == pos;
+            if ( !enabled )
+                continue;
+
+            int next = level;
+            for ( int set : e.accepting )
+                if ( set == next )
+                    ++ next;
+            bool accepting = next == sets;
+            yield( e.target * sets + ( accepting ? 0 : next ), accepting );
+        }
+    }
+};
+
+/*
+ * The product of the program (as explored by Builder) with a Property. The
+ * automaton state is kept next to the snapshot in the (product) State and
+ * never enters the program memory. A product edge consists of a program edge
+ * and an automaton transition whose guard holds in the source state of the
+ * program edge. Errors in the program are passed through, while acceptance
+ * is only determined by the automaton. The labels carry the target automaton
+ * state, so that a counterexample can be replayed exactly.
+ */
+
+template< typename Builder >
+struct Product : Builder
+{
+    using Snapshot = typename Builder::Snapshot;
+    using Label = typename Builder::Label;
+
+    struct State
+    {
+        Snapshot snap;
+        int buchi = 0; /* Property slot */
+        bool operator==( const State &o ) const
+        {
+            return snap.intptr() == o.snap.intptr() && buchi == o.buchi;
+        }
+        bool operator!=( const State &o ) const { return !( *this == o ); }
+    };
+
+    std::shared_ptr< const Property > _property;
+    vm::HeapPointer _globals;
+
+    Product( const Builder &b, std::shared_ptr< const Property > p )
+        : Builder( b ), _property( p ), _globals( this->context().globals() )
+    {}
+
+    int slots() const { return _property->slots(); }
+    static int slot( State s ) { return s.buchi; }
+
+    std::vector< bool > valuation( Snapshot snap )
+    {
+        std::vector< bool > val;
+        auto &heap = this->heap();
+        bool cold = heap.cold( this->pool() );
+
+        if ( cold )
+            heap.cold_enter();
+        this->context().load( this->pool(), snap );
+
+        for ( auto slot : _property->props )
+        {
+            bool set = false;
+            for ( int i = 0; i < slot.size(); ++i )
+            {
+                vm::value::Int< 8 > byte;
+                heap.read( vm::HeapPointer( _globals + int( slot.offset + i ) ), byte );
+                set = set || byte.cooked();
+            }
+            val.push_back( set );
+        }
+
+        if ( cold )
+            heap.cold_leave();
+        return val;
+    }
+
+    template< typename Y >
+    void edges( State from, Y yield )
+    {
+        std::vector< std::pair< int, bool > > steps;
+        _property->step( from.buchi, valuation( from.snap ),
+                         [&]( int to, bool accepting ) { steps.emplace_back( to, accepting ); } );
+
+        if ( steps.empty() )
+            return;
+
+        builder::State prog{ from.snap };
+        Builder::edges( prog, [&]( builder::State to, Label lbl, bool isnew )
+            {
+                for ( auto [ buchi, accepting ] : steps )
+                {
+                    lbl.accepting = accepting;
+                    lbl.buchi = buchi;
+                    yield( State{ to.snap, buchi }, lbl, isnew );
+                    isnew = false; /* all slots are initialised at once */
+                }
+            } );
+    }
+
+    template< typename Y >
+    void initials( Y yield )
+    {
+        Builder::initials( [&]( builder::State s )
+            {
+                yield( State{ s.snap, _property->start * _property->sets } );
+            } );
+    }
+};
+
+}
@@ -23,6 +23,8 @@
 #include <divine/mc/trace.hpp>
 #include <divine/mc/bitcode.hpp>
 
+#include <cstring>
+
 namespace divine::mc
 {
 
@@ -33,10 +35,29 @@ struct Safety : Job
     using MasterPool = typename vm::CowHeap::SnapPool;
     using SlavePool = brick::mem::SlavePool< MasterPool >;
     using StateTrace = mc::StateTrace< Builder >;
+    using Label = typename Builder::Label;
+
+    /* With BitCode::record_edges, the label of the edge that discovered a
+     * state is kept next to its parent pointer (the text trace excluded),
+     * so that the counterexample can be matched edge by edge, instead of
+     * comparing each successor with the expected state. */
+    struct Edge
+    {
+        Parent parent;
+        vm::CowHeap::Snapshot label;
+    };
+
+    struct EdgeLabel /* followed by the choices and the interrupts */
+    {
+        uint32_t choices:15, interrupts:15;
+        bool accepting:1, error:1;
+    };
 
     Builder _ex;
     SlavePool _ext;
+    MasterPool _labels;
     Next _next;
+    bool _record;
 
     bool _error_found;
     typename Builder::State _error, _error_to;
@@ -46,14 +67,19 @@ struct Safety : Job
     {
         return ss::make_search(
             _ex, ss::listen(
-                [&]( auto from, auto to, auto label, bool isnew )
+                /* the listener is copied for each thread, and so is the pool */
+                [&, labels = _labels]( auto from, auto to, auto label, bool isnew ) mutable
                 {
                     if ( isnew )
                     {
-                        _ext.materialise( to.snap, sizeof( from ) );
+                        _ext.materialise( to.snap, _record ? sizeof( Edge ) : sizeof( Parent ) );
                         Parent &parent = *_ext.machinePointer< Parent >( to.snap );
                         parent = from.snap;
+                        if ( _record )
+                            _ext.machinePointer< Edge >( to.snap )->label = store_label( labels, label );
                     }
+                    if ( label.error && _error_filter && _error_filter( from.snap, step( label ) ) )
+                        return ss::Listen::Ignore;
                     if ( label.error )
                     {
                         _error_found = true;
@@ -67,11 +93,57 @@ struct Safety : Job
                 [&]( auto st ) { return _next.state( st ); } ) );
     }
 
+    static vm::Step step( const Label &l )
+    {
+        vm::Step s;
+        s.interrupts.assign( l.interrupts.begin(), l.interrupts.end() );
+        s.choices.assign( l.stack.begin(), l.stack.end() );
+        return s;
+    }
+
+    static vm::CowHeap::Snapshot store_label( MasterPool &pool, const Label &l )
+    {
+        EdgeLabel el;
+        el.choices = l.stack.size();
+        el.interrupts = l.interrupts.size();
+        el.accepting = l.accepting;
+        el.error = l.error;
+
+        int c_size = el.choices * sizeof( vm::Choice ),
+            i_size = el.interrupts * sizeof( vm::Interrupt );
+        auto p = pool.allocate( sizeof( EdgeLabel ) + c_size + i_size );
+        auto mem = pool.template machinePointer< char >( p );
+        std::memcpy( mem, &el, sizeof( EdgeLabel ) );
+        std::memcpy( mem + sizeof( EdgeLabel ), l.stack.data(), c_size );
+        std::memcpy( mem + sizeof( EdgeLabel ) + c_size, l.interrupts.data(), i_size );
+        return p;
+    }
+
+    Label load_label( vm::CowHeap::Snapshot p )
+    {
+        auto mem = _labels.template machinePointer< char >( p );
+        EdgeLabel el;
+        std::memcpy( &el, mem, sizeof( EdgeLabel ) );
+
+        Label l;
+        l.stack.resize( el.choices, vm::Choice( 0, 0 ) );
+        l.interrupts.resize( el.interrupts );
+        l.accepting = el.accepting;
+        l.error = el.error;
+
+        int c_size = el.choices * sizeof( vm::Choice );
+        std::memcpy( l.stack.data(), mem + sizeof( EdgeLabel ), c_size );
+        std::memcpy( l.interrupts.data(), mem + sizeof( EdgeLabel ) + c_size,
+                     el.interrupts * sizeof( vm::Interrupt ) );
+        return l;
+    }
+
     template< typename... Args >
     Safety( std::shared_ptr< BitCode > bc, Next next, Args... builder_opts )
         : _ex( bc, builder_opts... ),
           _ext( _ex.pool() ),
           _next( next ),
+          _record( bc->record_edges() ),
           _error_found( false )
     {
         _ex.start();
@@ -96,6 +168,9 @@ struct Safety : Job
         };
         queuesize = [=]() { return search->qsize(); };
 
+        search->order( _order );
+        if ( _heuristic )
+            search->heuristic( [h = _heuristic]( auto &, auto &l ) { return h( l ); } );
         search->start( threads );
     }
 
@@ -109,7 +184,10 @@ struct Safety : Job
         auto i = _error.snap;
         while ( i != _ex._d.initial.snap )
         {
-            rv.emplace_front( i, std::nullopt );
+            if ( _record )
+                rv.emplace_front( i, load_label( _ext.machinePointer< Edge >( i )->label ) );
+            else
+                rv.emplace_front( i, std::nullopt );
             i = *_ext.machinePointer< vm::CowHeap::Snapshot >( i );
         }
         rv.emplace_front( _ex._d.initial.snap, std::nullopt );
@@ -122,13 +200,20 @@ struct Safety : Job
     {
         if ( !stats().first )
             return Result::BootError;
-        return _error_found ? Result::Error : Result::Valid;
+        if ( _error_found )
+            return Result::Error;
+        return _ex.dropped() ? Result::Partial : Result::Valid;
     }
 
     virtual PoolStats poolstats() override
     {
-        return PoolStats{ { "snapshot memory", _ex.pool().stats() },
-                          { "fragment memory", _ex.context().heap().mem_stats() } };
+        PoolStats ps{ { "snapshot memory", _ex.pool().stats() },
+                      { "fragment memory", _ex.context().heap().mem_stats() } };
+        if ( _ex.heap().cold( _ex.pool() ) )
+            ps.emplace( "cold memory", _ex.heap().cold_stats() );
+        if ( _record )
+            ps.emplace( "edge labels", _labels.stats() );
+        return ps;
     }
 
     template< typename HT >
@@ -141,6 +226,9 @@ struct Safety : Job
         return { used, capacity };
     }
 
+    void saturate() override { _ex.saturate(); }
+    int64_t dropped() override { return _ex.dropped(); }
+
     virtual HashStats hashstats() override
     {
         return HashStats{ { "snapshot table", _ex._d.states.stats() },
@@ -40,5 +40,24 @@ namespace divine::t_mc
             ASSERT_EQ( edgecount, 4 );
             ASSERT_EQ( statecount, 5 );
         }
+
+        TEST( record_edges )
+        {
+            auto run = []( bool record )
+            {
+                auto bc = prog_int( "4", "*r - 1" );
+                bc->record_edges( record );
+                auto safe = mc::make_job< mc::Safety >( bc, ss::passive_listen() );
+                safe->start( 1 );
+                safe->wait();
+                ASSERT_EQ( safe->result(), mc::Result::Error );
+                return safe->ce_trace();
+            };
+
+            auto plain = run( false ), recorded = run( true );
+            ASSERT_EQ( plain.steps.size(), recorded.steps.size() );
+            ASSERT( plain.labels == recorded.labels );
+            ASSERT( recorded.final.slab() );
+        }
     };
 }
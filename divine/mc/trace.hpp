@@ -92,9 +92,16 @@ Trace trace( Explore &ex, LabelledTrace< Label > states, LabelComparer comparer
 
                         if ( next == states.end() )
                             return ss::Listen::Terminate;
-                        if ( !ex.equal( to.snap, next->first ) )
-                            return ss::Listen::Ignore;
-                        if ( next->second.has_value() && !comparer( *next->second, label ) )
+
+                        /* the choices and interrupts in a label determine the successor, so
+                         * a known label spares us comparing the states; if it was wrong,
+                         * the next 'from' check fails and we end up with a BadTrace */
+                        if ( next->second.has_value() )
+                        {
+                            if ( !comparer( *next->second, label ) )
+                                return ss::Listen::Ignore;
+                        }
+                        else if ( !ex.equal( to.snap, next->first ) )
                             return ss::Listen::Ignore;
 
                         if ( label.error )
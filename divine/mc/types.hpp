@@ -28,7 +28,7 @@
 namespace divine::mc
 {
     struct BitCode;
-    enum class Result { None, Valid, Error, BootError };
+    enum class Result { None, Valid, Error, BootError, Partial }; /* partial: no error in the part explored */
 
     static std::ostream &operator<<( std::ostream &o, Result r )
     {
@@ -38,6 +38,7 @@ namespace divine::mc
             case Result::Valid: return o << "error found: no";
             case Result::Error: return o << "error found: yes";
             case Result::BootError: return o << "error found: boot";
+            case Result::Partial: return o << "error found: partial";
         }
     }
 
@@ -46,7 +47,8 @@ namespace divine::mc
         if      ( s == "valid" ) r = Result::Valid;
         else if ( s == "error" ) r = Result::Error;
         else if ( s == "boot-error" ) r = Result::BootError;
-        else return brq::no_parse( "expected 'valid', 'error' or 'boot-error'" );
+        else if ( s == "partial" ) r = Result::Partial;
+        else return brq::no_parse( "expected 'valid', 'error', 'boot-error' or 'partial'" );
 
         return {};
     }
@@ -73,4 +75,21 @@ namespace divine::mc
 
     using divm_timer = brq::timer< divm_timer_tag >;
     using hash_timer = brq::timer< hash_timer_tag >;
+
+    struct grow_timer_tag;
+    struct reexec_timer_tag;
+
+    /* only active with brq::profiling */
+    using grow_timer = brq::timer< grow_timer_tag >;
+    using reexec_timer = brq::timer< reexec_timer_tag >;
+
+    struct ProfileItem { long cycles = 0, hits = 0; };
+
+    /* timer readings broken down by thread (brq::impl::timer_slot) */
+    struct ProfileStats
+    {
+        long wall = 0; /* cycles since profiling started */
+        std::map< int, std::map< std::string, ProfileItem > > threads;
+        bool empty() const { return threads.empty(); }
+    };
 }
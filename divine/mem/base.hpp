@@ -106,6 +106,9 @@ struct Base
     template< typename S, typename F >
     void hash( Internal, int, S &, F ) const {}
 
+    /* true if the object carries no out-of-band metadata (exceptions) */
+    bool plain( Internal, int ) const { return true; }
+
     static constexpr bool can_snapshot() { return false; }
 };
 
@@ -19,15 +19,30 @@
 #pragma once
 
 #include <brick-types>
+#include <brick-except>
 #include <brick-hash>
 #include <brick-hashset>
 #include <brick-mem>
+#include <brick-lz>
+#include <brick-timer>
+#include <divine/mem/tree.hpp>
 #include <unordered_set>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
 
 namespace divine::mem
 {
 
     using brq::hash64_t;
+
+    struct snapshot_timer_tag;
+    struct dedup_timer_tag;
+
+    /* only active with brq::profiling */
+    using snapshot_timer = brq::timer< snapshot_timer_tag >;
+    using dedup_timer = brq::timer< dedup_timer_tag >;
     template< typename Next >
     struct Cow : Next
     {
@@ -38,6 +53,7 @@ namespace divine::mem
         using typename Next::Loc;
         using typename Next::Pool;
         using Next::_l; /* FIXME */
+        using Tree = mem::Tree< Pool, SnapItem >;
 
         mutable brick::mem::RefPool< Pool, uint8_t, true > _obj_refcnt;
 
@@ -65,29 +81,81 @@ namespace divine::mem
             typename HA::Erase erase( cell &c, const X &t, hash64_t ) const;
         };
 
+        /* Bookkeeping for cold storage, shared by all copies of the heap. An
+         * object replaced by its compressed form is only released once every
+         * thread that could have seen it has left its critical section, i.e.
+         * once the epoch in which it was retired is older than all active
+         * epochs. Each heap copy that enters holds a slot in 'active' until
+         * it is destroyed (or switches to other cold storage); 'threads' is
+         * the highest slot ever taken, plus one. */
+        struct Cold
+        {
+            static constexpr int max_threads = 256;
+            std::atomic< int64_t > epoch = 1;
+            std::atomic< int > threads = 0;
+            std::array< std::atomic< int64_t >, max_threads > active; /* 0 = idle */
+            std::array< std::atomic< bool >, max_threads > taken;
+            std::mutex mutex;
+            std::deque< std::pair< int64_t, Internal > > retired;
+            std::atomic< int64_t > count = 0, raw = 0, packed = 0;
+
+            Cold()
+            {
+                for ( auto &a : active ) a = 0;
+                for ( auto &t : taken ) t = false;
+            }
+        };
+
         mutable struct Ext
         {
             ObjHasher hasher;
             brq::concurrent_hash_set< Internal > objects;
             Pool *_free_pool = nullptr;
             Snapshot _free_snap;
+            typename Tree::Table tree;
+            const void *tree_owner = nullptr;
+            typename Tree::Table blobs;
+            std::shared_ptr< Cold > cold;
         } _ext;
 
+        /* the expanded form of the current snapshot, if it is tree-compressed */
+        mutable std::vector< SnapItem > _tree_buf;
+        mutable Snapshot _tree_snap;
+
+        /* objects decompressed by restore(), referenced by this heap copy */
+        mutable std::vector< Internal > _thawed;
+        int _cold_slot = -1;
+
         void setupHT() { _ext.hasher._heap = this; }
 
+        void setup_tree( const Cow &o )
+        {
+            _tree_buf = o._tree_buf;
+            _tree_snap = o._tree_snap;
+            if ( _l.snap_begin && _l.snap_begin == o._tree_buf.data() )
+                _l.snap_begin = _tree_buf.data();
+        }
+
         Cow() : _obj_refcnt( this->_objects ) { setupHT(); }
         Cow( const Cow &o ) : Next( o ), _obj_refcnt( o._obj_refcnt ), _ext( o._ext )
         {
             setupHT();
+            setup_tree( o );
             ASSERT( _l.exceptions.empty() );
         }
 
+        ~Cow() { cold_release(); }
+
         Cow &operator=( const Cow &o )
         {
+            thaw_put();
+            if ( _ext.cold != o._ext.cold )
+                cold_release();
             Next::operator=( o );
             _obj_refcnt = o._obj_refcnt;
             _ext = o._ext;
             setupHT();
+            setup_tree( o );
             ASSERT( _l.exceptions.empty() );
             return *this;
         }
@@ -99,7 +167,24 @@ namespace divine::mem
             return Next::copy( from_h, from, to_h, to, bytes, internal );
         }
 
+        /* A cheap alternative to snapshot() for tree exploration, where most
+         * states are only resumed once or twice and never compared: the
+         * current base snapshot is shared as is, only the dirty objects (the
+         * exception set) are copied. Nothing is interned or hashed. The base
+         * snapshot must outlive the fork, which rules out tree compression
+         * (the base then lives in _tree_buf, which is private to the heap). */
+        struct Fork
+        {
+            SnapItem *snap_begin = nullptr;
+            int snap_size = 0;
+            std::vector< std::pair< uint32_t, Internal > > dirty;
+        };
+
         Internal detach( Loc l );
+        Internal dup( uint32_t objid, Internal obj );
+        Fork fork();
+        void restore( Fork &f, bool take );
+        void fork_put( Fork &f );
         Snapshot snapshot( Pool &p ) const;
         SnapItem snap_dedup( SnapItem si ) const;
         void snap_put( Pool &p, Snapshot s );
@@ -111,16 +196,95 @@ namespace divine::mem
             return si;
         }
 
+        void obj_put( Internal i ) const
+        {
+            _obj_refcnt.put( i, [&]( auto x, int refcnt )
+            {
+                if ( refcnt == 1 )
+                    _ext.objects.erase( x, _ext.hasher );
+                return true;
+            } );
+        }
+
+        /* Snapshots stored in the pool 'p' will be tree-compressed from now
+         * on. The node table is shared by all copies of this heap. */
+        void tree_compression( Pool &p ) { _ext.tree_owner = p._s.ptr(); }
+        bool tree( Pool &p ) const { return _ext.tree_owner && _ext.tree_owner == p._s.ptr(); }
+
+        /* Objects of explored states stored in the (tree-compressed) pool
+         * 'p' may be moved into compressed cold storage from now on, see
+         * freeze(). The objects are decompressed again by restore(). */
+        void cold_compression( Pool &p )
+        {
+            ASSERT( tree( p ) );
+            cold_release();
+            _ext.cold = std::make_shared< Cold >();
+        }
+
+        bool cold( Pool &p ) const { return _ext.cold && tree( p ); }
+
+        /* A snapshot item refers to a compressed blob instead of a live
+         * object if its tag is clear: live objects always carry the status
+         * bits of their cell in the object table. */
+        static bool blob( Internal i ) { return ( i.tag() & 3 ) == 0; }
+
+        void cold_enter();
+        void cold_leave();
+        void cold_release();
+        void freeze( Pool &p, Snapshot s );
+        Internal freeze( Internal obj ) const;
+        SnapItem thaw( SnapItem si );
+        void thaw_put() const;
+        void reclaim() const;
+
+        brick::mem::Stats cold_stats() const
+        {
+            brick::mem::Stats s;
+            if ( _ext.cold )
+            {
+                s.total.count.used = s.total.count.held = _ext.cold->count;
+                s.total.bytes.used = _ext.cold->packed;
+                s.total.bytes.held = _ext.cold->raw;
+            }
+            return s;
+        }
+
         bool is_shared( Pool &p, Snapshot s ) const
         {
+            if ( tree( p ) )
+                return s == _tree_snap;
             return p.template machinePointer< SnapItem >( s ) == _l.snap_begin;
         }
 
+        bool snap_equal( Pool &p, Snapshot a, Snapshot b ) const
+        {
+            if ( tree( p ) )
+                return Tree::equal( p, a, b );
+            return p.size( a ) == p.size( b ) &&
+                   std::equal( this->snap_begin( p, a ), this->snap_end( p, a ),
+                               this->snap_begin( p, b ) );
+        }
+
         void restore( Pool &p, Snapshot s )
         {
             snap_put();
-            _l.snap_size = p.size( s ) / sizeof( SnapItem );
-            _l.snap_begin = p.template machinePointer< SnapItem >( s );
+            thaw_put();
+            if ( tree( p ) )
+            {
+                Tree::expand( p, s, _tree_buf );
+                if ( cold( p ) )
+                    for ( auto &si : _tree_buf )
+                        if ( blob( si.second ) )
+                            si = thaw( si ), _thawed.push_back( Internal( si.second ) );
+                _tree_snap = s;
+                _l.snap_size = _tree_buf.size();
+                _l.snap_begin = _tree_buf.data();
+            }
+            else
+            {
+                _l.snap_size = p.size( s ) / sizeof( SnapItem );
+                _l.snap_begin = p.template machinePointer< SnapItem >( s );
+            }
             _l.exceptions.clear();
         }
 
@@ -41,7 +41,10 @@ namespace divine::mem
 
         if ( cell.tombstone() )
             if ( cell.revive() )
+            {
                 TRACE( "revive", x, "refcnt =",  _heap->_obj_refcnt.count( a ) );
+                heap()._ext.objects.revived();
+            }
 
         return cell.value();
     }
@@ -85,9 +88,70 @@ namespace divine::mem
         return newobj;
     }
 
+    template< typename Next >
+    auto Cow< Next >::dup( uint32_t objid, Internal obj ) -> Internal
+    {
+        int sz = this->size( obj );
+        auto newobj = this->objects().allocate( sz );
+        Next::materialise( newobj, sz );
+
+        auto res = this->copy( *this, Loc( obj, objid, 0 ), *this, Loc( newobj, objid, 0 ), sz, true );
+        ASSERT( res );
+        return newobj;
+    }
+
+    template< typename Next >
+    auto Cow< Next >::fork() -> Fork
+    {
+        ASSERT( _tree_buf.empty() || _l.snap_begin != _tree_buf.data() );
+        Fork f;
+        f.snap_begin = _l.snap_begin;
+        f.snap_size = _l.snap_size;
+
+        for ( auto [ objid, obj ] : _l.exceptions )
+            f.dirty.emplace_back( objid, this->valid( obj ) ? dup( objid, obj ) : obj );
+
+        return f;
+    }
+
+    /* Resume from a fork. Unless 'take' is set (the last branch to resume),
+     * the dirty objects are copied again, since the heap writes into its
+     * exceptions in place. The private objects of the current state are
+     * released: nothing else can refer to them. */
+    template< typename Next >
+    void Cow< Next >::restore( Fork &f, bool take )
+    {
+        snap_put();
+        thaw_put();
+
+        for ( auto [ objid, obj ] : _l.exceptions )
+            if ( this->valid( obj ) )
+                this->free( obj );
+        _l.exceptions.clear();
+
+        _l.snap_begin = f.snap_begin;
+        _l.snap_size = f.snap_size;
+
+        for ( auto [ objid, obj ] : f.dirty )
+            _l.exceptions[ objid ] = take || !this->valid( obj ) ? obj : dup( objid, obj );
+
+        if ( take )
+            f.dirty.clear();
+    }
+
+    template< typename Next >
+    void Cow< Next >::fork_put( Fork &f )
+    {
+        for ( auto [ objid, obj ] : f.dirty )
+            if ( this->valid( obj ) )
+                this->free( obj );
+        f.dirty.clear();
+    }
+
     template< typename Next >
     auto Cow< Next >::snap_dedup( SnapItem si ) const -> SnapItem
     {
+        dedup_timer _timer( brq::profiling );
         auto r = _ext.objects.insert( si.second, _ext.hasher );
         if ( r->load() == si.second )
             _obj_refcnt.get( si.second ); /* for the hash table reference */
@@ -117,22 +181,201 @@ namespace divine::mem
         auto s = _ext._free_snap;
         _ext._free_pool = nullptr;
 
-        auto erase = [&]( auto x, int refcnt )
+        if ( tree( p ) )
         {
-            if ( refcnt == 1 )
-                _ext.objects.erase( x, _ext.hasher );
-            return true;
-        };
-
-        for ( auto si = this->snap_begin( p, s ); si != this->snap_end( p, s ); ++si )
-            _obj_refcnt.put( si->second, erase );
+            std::vector< SnapItem > items;
+            Tree::expand( p, s, items );
+            for ( auto &si : items )
+                if ( !cold( p ) || !blob( si.second ) )
+                    obj_put( si.second );
+        }
+        else
+            for ( auto si = this->snap_begin( p, s ); si != this->snap_end( p, s ); ++si )
+                obj_put( si->second );
 
         p.free( s );
     }
 
+    template< typename Next >
+    void Cow< Next >::thaw_put() const
+    {
+        for ( auto i : _thawed )
+            obj_put( i );
+        _thawed.clear();
+    }
+
+    /* Replace the objects of a stored (tree-compressed) snapshot by their
+     * compressed form. The snapshot keeps its identity, only its root node is
+     * swapped; objects which cannot be stored losslessly in a flat form (those
+     * with metadata exceptions) or which do not compress stay as they are. */
+
+    template< typename Next >
+    void Cow< Next >::freeze( Pool &p, Snapshot s )
+    {
+        if ( !cold( p ) || !s.slab() )
+            return;
+
+        auto node = Tree::node( p, s );
+        if ( node.tag() ) /* frozen already */
+            return;
+
+        std::vector< SnapItem > items;
+        std::vector< Internal > retire;
+        Tree::expand( p, s, items );
+
+        for ( auto &si : items )
+            if ( auto b = freeze( si.second ); b.slab() )
+                retire.push_back( Internal( si.second ) ), si.second = b;
+
+        auto frozen = retire.empty() ? node : Tree::build( p, _ext.tree, items.data(), items.size() );
+        frozen.tag( 1 );
+
+        if ( !Tree::replace( p, s, node, frozen ) )
+            return;
+
+        auto &c = *_ext.cold;
+        std::lock_guard< std::mutex > _lock( c.mutex );
+        auto epoch = c.epoch ++;
+        for ( auto i : retire )
+            c.retired.emplace_back( epoch, i );
+        reclaim();
+    }
+
+    template< typename Next >
+    auto Cow< Next >::freeze( Internal obj ) const -> Internal
+    {
+        int size = this->size( obj ), meta = Next::meta_size( size );
+        if ( !this->plain( obj, size ) )
+            return Internal();
+
+        std::vector< uint8_t > buf( 2 * sizeof( int32_t ) + brq::lz::bound( size ) + brq::lz::bound( meta ) );
+        uint8_t *data = buf.data() + 2 * sizeof( int32_t );
+        int32_t data_packed = brq::lz::compress( this->unsafe_ptr2mem( obj ), size, data );
+        std::vector< uint8_t > flat;
+        const uint8_t *shadow = this->meta_raw( obj );
+        if ( auto u = this->uniform( obj ) ) /* do not flatten a shared object */
+            flat.resize( meta, Next::fill( u ) ), shadow = flat.data();
+
+        int32_t packed = brq::lz::compress( shadow, meta, data + data_packed );
+        packed += data_packed + 2 * sizeof( int32_t );
+
+        if ( packed >= size + meta )
+            return Internal();
+
+        std::memcpy( buf.data(), &size, sizeof( int32_t ) );
+        std::memcpy( buf.data() + sizeof( int32_t ), &data_packed, sizeof( int32_t ) );
+
+        auto &pool = this->objects();
+        auto b = pool.allocate( packed );
+        std::memcpy( pool.dereference( b ), buf.data(), packed );
+
+        auto r = _ext.blobs.insert( b, typename Tree::Hasher( pool ) )->load();
+        if ( r == b )
+        {
+            _ext.cold->count ++;
+            _ext.cold->raw += size + meta;
+            _ext.cold->packed += packed;
+        }
+        else
+            pool.free( b );
+
+        r.tag( 0 ); /* blobs are never freed and do not need refcounts */
+        return r;
+    }
+
+    template< typename Next >
+    auto Cow< Next >::thaw( SnapItem si ) -> SnapItem
+    {
+        auto &pool = this->objects();
+        auto blob = pool.template machinePointer< uint8_t >( si.second );
+        int32_t size, data_packed, packed = pool.size( si.second ) - 2 * sizeof( int32_t );
+
+        std::memcpy( &size, blob, sizeof( int32_t ) );
+        std::memcpy( &data_packed, blob + sizeof( int32_t ), sizeof( int32_t ) );
+        blob += 2 * sizeof( int32_t );
+
+        int meta = Next::meta_size( size );
+        auto obj = pool.allocate( size );
+        Next::materialise( obj, size );
+        this->uniform( obj, Next::Stored );
+
+        auto data_sz = brq::lz::decompress( blob, data_packed, this->unsafe_ptr2mem( obj ), size );
+        auto meta_sz = brq::lz::decompress( blob + data_packed, packed - data_packed,
+                                            this->meta_raw( obj ), meta );
+        ASSERT_EQ( data_sz, size );
+        ASSERT_EQ( meta_sz, meta );
+
+        this->settle( obj );
+        si.second = obj;
+        return snap_dedup( si );
+    }
+
+    template< typename Next >
+    void Cow< Next >::cold_enter()
+    {
+        auto &c = *_ext.cold;
+
+        for ( int i = 0; _cold_slot < 0; ++i )
+        {
+            if ( i == Cold::max_threads )
+                throw brq::error( "cold storage: more than " + std::to_string( Cold::max_threads )
+                                  + " heaps in use at once" );
+            if ( bool free = false; c.taken[ i ].compare_exchange_strong( free, true ) )
+            {
+                _cold_slot = i;
+                for ( int t = c.threads; t <= i && !c.threads.compare_exchange_weak( t, i + 1 ); );
+            }
+        }
+
+        int64_t epoch;
+        do {
+            epoch = c.epoch;
+            c.active[ _cold_slot ] = epoch;
+        } while ( c.epoch != epoch );
+    }
+
+    template< typename Next >
+    void Cow< Next >::cold_leave()
+    {
+        _ext.cold->active[ _cold_slot ] = 0;
+    }
+
+    /* give the slot back, so that the next copy of the heap can use it */
+    template< typename Next >
+    void Cow< Next >::cold_release()
+    {
+        if ( _cold_slot < 0 )
+            return;
+
+        auto &c = *_ext.cold;
+        c.active[ _cold_slot ] = 0;
+        c.taken[ _cold_slot ] = false;
+        _cold_slot = -1;
+    }
+
+    /* release retired objects no thread can be looking at anymore; the
+     * caller holds the mutex */
+    template< typename Next >
+    void Cow< Next >::reclaim() const
+    {
+        auto &c = *_ext.cold;
+        int64_t oldest = c.epoch;
+
+        for ( int i = 0; i < c.threads; ++i )
+            if ( int64_t e = c.active[ i ] )
+                oldest = std::min( oldest, e );
+
+        while ( !c.retired.empty() && c.retired.front().first < oldest )
+        {
+            obj_put( c.retired.front().second );
+            c.retired.pop_front();
+        }
+    }
+
     template< typename Next >
     auto Cow< Next >::snapshot( Pool &p ) const -> Snapshot
     {
+        snapshot_timer _timer( brq::profiling );
         int count = 0;
         auto snap = this->snap_begin();
 
@@ -152,8 +395,16 @@ namespace divine::mem
         if ( !count )
             return Snapshot();
 
-        auto s = p.allocate( count * sizeof( SnapItem ) );
-        auto si = p.template machinePointer< SnapItem >( s );
+        bool compress = tree( p );
+        std::vector< SnapItem > buf;
+        Snapshot s;
+
+        if ( compress )
+            buf.resize( count );
+        else
+            s = p.allocate( count * sizeof( SnapItem ) );
+
+        auto si = compress ? buf.data() : p.template machinePointer< SnapItem >( s );
         snap = this->snap_begin();
 
         for ( auto &except : _l.exceptions )
@@ -163,19 +414,34 @@ namespace divine::mem
             if ( snap != this->snap_end() && snap->first == except.first )
                 snap++;
             if ( this->valid( except.second ) )
+            {
+                this->settle( except.second );
                 *si++ = snap_dedup( except );
+            }
         }
 
         while ( snap != this->snap_end() )
             *si++ = *snap_get( snap++ );
 
-        auto newsnap = p.template machinePointer< SnapItem >( s );
+        auto newsnap = compress ? buf.data() : p.template machinePointer< SnapItem >( s );
         ASSERT_EQ( si, newsnap + count );
         for ( auto s = newsnap; s < newsnap + count; ++s )
             ASSERT( this->valid( s->second ) );
 
+        if ( compress )
+            s = Tree::compress( p, _ext.tree, newsnap, count );
+
         snap_put();
+        thaw_put();
         _l.exceptions.clear();
+
+        if ( compress )
+        {
+            _tree_buf.swap( buf );
+            _tree_snap = s;
+            newsnap = _tree_buf.data();
+        }
+
         _l.snap_begin = newsnap;
         _l.snap_size = count;
 
@@ -49,6 +49,7 @@ namespace divine::mem
             uint32_t first;
             Internal second;
             operator std::pair< uint32_t, Internal >() { return std::make_pair( first, second ); }
+            SnapItem() = default;
             SnapItem( std::pair< const uint32_t, Internal > p ) : first( p.first ), second( p.second ) {}
             bool operator==( SnapItem si ) const { return si.first == first && si.second == second; }
         } __attribute__((packed));
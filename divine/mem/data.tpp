@@ -19,6 +19,7 @@
 #pragma once
 
 #include <divine/mem/data.hpp>
+#include <divine/mem/simd.hpp>
 
 namespace divine::mem
 {
@@ -121,11 +122,27 @@ namespace divine::mem
     {
         int total_bytes = bytes;
         auto word = reinterpret_cast< uint32_t * >( unsafe_ptr2mem( i ) );
-        auto meta = this->compressed( Loc( i, 0, 0 ), ( bytes + 3 ) / 4 );
+        auto meta = this->stored( Loc( i, 0, 0 ), ( bytes + 3 ) / 4 );
         auto c = meta.begin();
 
+        if ( this->uniform( i ) ) /* there are no pointers */
+        {
+            state.template update< true >( reinterpret_cast< uint8_t * >( word ), bytes & ~3 );
+            word += bytes / 4, bytes %= 4;
+        }
+
         for ( ; bytes >= 4 ; bytes -= 4, word++, c++ )
         {
+            if constexpr ( Next::BitsPerWord == 8 ) /* hash runs of plain words at once */
+            {
+                int run = simd::find( this->meta_raw( i ) + ( total_bytes - bytes ) / 4, bytes / 4,
+                                      Next::pointer_any, Next::pointer_all );
+                state.template update< true >( reinterpret_cast< uint8_t * >( word ), 4 * run );
+                bytes -= 4 * run, word += run, c += run;
+                if ( bytes < 4 )
+                    break;
+            }
+
             if ( Next::is_pointer( *c ) )
                 ptr_cb( *word );
 
@@ -146,23 +163,43 @@ namespace divine::mem
         int total_bytes = bytes;
         auto a_word = reinterpret_cast< uint32_t * >( unsafe_ptr2mem( a ) ),
              b_word = reinterpret_cast< uint32_t * >( unsafe_ptr2mem( b ) );
-        auto a_meta = this->compressed( Loc( a, 0, 0 ), ( bytes + 3 ) / 4 ),
-             b_meta = this->compressed( Loc( b, 0, 0 ), ( bytes + 3 ) / 4 );
-        auto a_miter = a_meta.begin(), b_miter = b_meta.begin();
+        auto ua = this->uniform( a ), ub = this->uniform( b );
+        auto a_meta = this->view( a, ( bytes + 3 ) / 4 ),
+             b_meta = this->view( b, ( bytes + 3 ) / 4 );
 
-        for ( ; bytes >= 4 ; bytes -= 4, a_word++, b_word++, a_miter++, b_miter++ )
+        for ( ; bytes >= 4 ; bytes -= 4, a_word++, b_word++ )
         {
-            if ( int v = Next::is_pointer( *b_miter ) - Next::is_pointer( *a_miter ) )
+            int word = ( total_bytes - bytes ) / 4;
+
+            if constexpr ( Next::BitsPerWord == 8 ) /* skip equal plain words */
+            {
+                /* the shadow of a uniform object is plain throughout */
+                int words = bytes / 4, run = words;
+                if ( !ua || !ub )
+                    run = simd::find( ua ? this->meta_raw( b ) + word : this->meta_raw( a ) + word,
+                                      ua || ub ? nullptr : this->meta_raw( b ) + word, words,
+                                      Next::pointer_any, Next::pointer_all );
+                run = std::min( run, int( simd::mismatch( reinterpret_cast< uint8_t * >( a_word ),
+                                                          reinterpret_cast< uint8_t * >( b_word ),
+                                                          4 * run ) / 4 ) );
+                bytes -= 4 * run, a_word += run, b_word += run, word += run;
+                if ( bytes < 4 )
+                    break;
+            }
+
+            auto c_a = a_meta[ word ], c_b = b_meta[ word ];
+
+            if ( int v = Next::is_pointer( c_b ) - Next::is_pointer( c_a ) )
                 return v;
 
-            if ( Next::is_pointer( *a_miter ) )
+            if ( Next::is_pointer( c_a ) )
                 if ( int v = ptr_cb( *a_word, *b_word ) )
                     return v;
 
-            if ( int v = Next::is_pointer_exception( *b_miter ) - Next::is_pointer_exception( *a_miter ) )
+            if ( int v = Next::is_pointer_exception( c_b ) - Next::is_pointer_exception( c_a ) )
                 return v;
 
-            if ( !Next::is_pointer( *a_miter ) && Next::is_pointer_exception( *a_miter ) )
+            if ( !Next::is_pointer( c_a ) && Next::is_pointer_exception( c_a ) )
             {
                 auto a_mask = this->pointer_exception( a, total_bytes - bytes ).mask(),
                      b_mask = this->pointer_exception( b, total_bytes - bytes ).mask();
@@ -170,14 +207,11 @@ namespace divine::mem
                     return v;
             }
 
-            if ( !Next::is_pointer( *a_miter ) && !Next::is_pointer_exception( *a_miter ) )
+            if ( !Next::is_pointer( c_a ) && !Next::is_pointer_exception( c_a ) )
                 if ( int v = *b_word - *a_word )
                     return v;
         }
 
-        a_miter ++;
-        b_miter ++;
-
         auto a_byte = reinterpret_cast< uint8_t * >( a_word ),
              b_byte = reinterpret_cast< uint8_t * >( b_word );
 
@@ -118,7 +118,18 @@ namespace divine::mem
         static constexpr bool can_snapshot() { return Next::can_snapshot(); }
         Snapshot snapshot( Pool &p ) { return n.snapshot( p ); }
         void restore( Pool &p, Snapshot s ) { n.restore( p, s ); }
+        auto fork() { return n.fork(); }
+        template< typename Fork > void restore( Fork &f, bool take ) { n.restore( f, take ); }
+        template< typename Fork > void fork_put( Fork &f ) { n.fork_put( f ); }
         bool is_shared( Pool &p, Snapshot s ) const { return n.is_shared( p, s ); }
+        bool snap_equal( Pool &p, Snapshot a, Snapshot b ) const { return n.snap_equal( p, a, b ); }
+        void tree_compression( Pool &p ) { n.tree_compression( p ); }
+        void cold_compression( Pool &p ) { n.cold_compression( p ); }
+        bool cold( Pool &p ) const { return n.cold( p ); }
+        void cold_enter() { n.cold_enter(); }
+        void cold_leave() { n.cold_leave(); }
+        void freeze( Pool &p, Snapshot s ) { n.freeze( p, s ); }
+        auto cold_stats() const { return n.cold_stats(); }
         void reset() { n.reset(); }
         void snap_put( Pool &p, Snapshot s ) { n.snap_put( p, s ); }
 
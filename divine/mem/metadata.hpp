@@ -20,7 +20,10 @@
 #pragma once
 
 #include <brick-types>
+#include <algorithm>
+#include <cstring>
 #include <divine/mem/bitset.hpp>
+#include <divine/mem/simd.hpp>
 
 namespace divine::mem
 {
@@ -146,6 +149,11 @@ struct CompressPDT : Next
     {
         return ( c & 0xF0 ) == 0x70;
     }
+
+    // Patterns for vectorised scans (see simd.hpp) which match a superset of
+    // the non-trivial words and of the pointer-or-exception words.
+    static constexpr uint8_t exception_any = 0, exception_all = 0x60;
+    static constexpr uint8_t pointer_any = 0x80, pointer_all = 0x60;
 };
 
 union ExpandedMetaPD // Representation the shadow layers operate on
@@ -209,6 +217,9 @@ struct CompressPD : Next
     {
         return c & 0x20;
     }
+
+    static constexpr uint8_t exception_any = 0x60, exception_all = 0;
+    static constexpr uint8_t pointer_any = 0x30, pointer_all = 0;
 };
 
 /*
@@ -225,6 +236,7 @@ struct Metadata : Next
 {
     using typename Next::Pool;
     using MetaPool = brick::mem::SlavePool< Pool >;
+    using CompressedC = BitsetContainer< Next::BitsPerWord, MetaPool >;
     using typename Next::Internal;
     using typename Next::Loc;
     using typename Next::Compressed;
@@ -236,10 +248,29 @@ struct Metadata : Next
     static_assert( sizeof( Compressed ) * 8 >= BPW,
                    "Next::Compressed does not contain all bits per word" );
 
-    mutable MetaPool _meta;
-    Metadata() : _meta( Next::_objects ) {}
+    /*
+     * Objects with uniform metadata (every word fully undefined or every word
+     * fully defined, with no pointers, taints or exceptions) do not keep their
+     * shadow in _meta: a per-object tag in _uniform says which of the two it
+     * is. The shadow is only written out (flattened) when a write or a copy
+     * breaks the uniformity, and objects are tagged again when they enter a
+     * snapshot (see settle). The operations below give the same results for
+     * tagged and for flattened objects. Since objects in snapshots are shared
+     * between threads, only private objects may ever be flattened.
+     */
+    enum Uniform : uint8_t { Stored, Undefined, Defined };
+
+    mutable MetaPool _meta, _uniform;
+    Metadata() : _meta( Next::_objects ), _uniform( Next::_objects ) {}
     auto &meta() { return _meta; }
-    void materialise( Internal i, int size ) { _meta.materialise( i, meta_size( size ) ); }
+    uint8_t *meta_raw( Internal i ) const { return _meta.template machinePointer< uint8_t >( i ); }
+
+    void materialise( Internal i, int size )
+    {
+        _meta.materialise( i, meta_size( size ), false );
+        _uniform.materialise( i, 1, false );
+        uniform( i, Undefined );
+    }
 
     static constexpr int meta_size( int size )
     {
@@ -247,6 +278,93 @@ struct Metadata : Next
         return ( size / divisor ) + ( size % divisor ? 1 : 0 );
     }
 
+    Uniform uniform( Internal i ) const
+    {
+        return Uniform( *_uniform.template machinePointer< uint8_t >( i ) );
+    }
+
+    void uniform( Internal i, Uniform u ) const
+    {
+        *_uniform.template machinePointer< uint8_t >( i ) = u;
+    }
+
+    static Compressed fill( Uniform u )
+    {
+        Expanded exp;
+        exp.defined = u == Defined ? 0xF : 0;
+        return Next::compress( exp );
+    }
+
+    static Uniform classify( const Expanded *exp, int words )
+    {
+        for ( auto u : { Defined, Undefined } )
+            if ( std::all_of( exp, exp + words, [&]( auto e ) { return Next::compress( e ) == fill( u ); } ) )
+                return u;
+        return Stored;
+    }
+
+    void flatten( Internal i ) const
+    {
+        auto u = uniform( i );
+        if ( u == Stored )
+            return;
+
+        for ( auto c : CompressedC( _meta, i, 0, ( Next::_objects.size( i ) + 3 ) / 4 ) )
+            c = fill( u );
+        uniform( i, Stored );
+    }
+
+    /* Tag a (private) object with stored metadata if it turns out to be
+     * uniform. Called when the object is about to enter a snapshot. */
+    void settle( Internal i ) const
+    {
+        int words = ( Next::_objects.size( i ) + 3 ) / 4;
+        if ( uniform( i ) != Stored || !words )
+            return;
+
+        auto sh = CompressedC( _meta, i, 0, words );
+        Compressed first = sh[ 0 ];
+        if ( first != fill( Defined ) && first != fill( Undefined ) )
+            return;
+
+        if constexpr ( BPW == 8 )
+        {
+            if ( int( simd::mismatch( meta_raw( i ), meta_raw( i ) + 1, words - 1 ) ) < words - 1 )
+                return;
+        }
+        else
+            for ( Compressed c : sh )
+                if ( c != first )
+                    return;
+
+        uniform( i, first == fill( Defined ) ? Defined : Undefined );
+    }
+
+    /* A read-only view of the shadow which never flattens the object. */
+    struct UniformC
+    {
+        CompressedC stored;
+        Compressed _fill;
+        bool _uniform;
+
+        Compressed operator[]( int w ) { return _uniform ? _fill : Compressed( stored[ w ] ); }
+    };
+
+    UniformC view( Internal i, int words ) const
+    {
+        auto u = uniform( i );
+        return UniformC{ CompressedC( _meta, i, 0, words ), fill( u ), u != Stored };
+    }
+
+    /* Stands in for an iterator over the shadow of a uniform object. */
+    struct UniformI
+    {
+        Compressed c;
+        Compressed operator*() const { return c; }
+        UniformI &operator++() { return *this; }
+        UniformI operator++( int ) { return *this; }
+    };
+
     // Compares expanded metadata through all layers.
     template< typename F >
     int compare( Internal a_obj, Internal b_obj, F ptr_cb, int sz ) const
@@ -254,19 +372,39 @@ struct Metadata : Next
         int cmp;
         const int words = ( sz + 3 ) / 4;
 
+        if ( uniform( a_obj ) || uniform( b_obj ) )
+        {
+            /* words of a uniform object are trivial, hence so are equal words */
+            auto sh_a = view( a_obj, words ), sh_b = view( b_obj, words );
+            for ( int w = 0; w < words; ++w )
+                if ( ( cmp = sh_a[ w ] - sh_b[ w ] ) )
+                    return cmp;
+            return Next::compare( a_obj, b_obj, ptr_cb, sz );
+        }
+
         auto a = Loc( a_obj, 0, 0 );
         auto b = Loc( b_obj, 0, 0 );
-        auto sh_a = compressed( a, words );
-        auto sh_b = compressed( b, words );
+        auto sh_a = stored( a, words );
+        auto sh_b = stored( b, words );
         auto i_a = sh_a.begin();
         auto i_b = sh_b.begin();
 
         int off = 0;
+        const uint8_t *raw_a = meta_raw( a_obj ), *raw_b = meta_raw( b_obj );
 
         // This assumes that whole objects are being compared, i.e. that there are no actual data
         // after 'sz' bytes.
         for ( ; off < bitlevel::align( sz, 4 ); off += 4 )
         {
+            if constexpr ( BPW == 8 ) /* skip over words that are equal and trivial */
+            {
+                int skip = simd::find( raw_a + off / 4, raw_b + off / 4, words - off / 4,
+                                       Next::exception_any, Next::exception_all );
+                off += 4 * skip, i_a += skip, i_b += skip;
+                if ( off >= bitlevel::align( sz, 4 ) )
+                    break;
+            }
+
             Compressed c_a = *i_a++;
             Compressed c_b = *i_b++;
             if ( ( cmp = c_a - c_b ) )
@@ -287,16 +425,44 @@ struct Metadata : Next
     {
         auto s = meta_size( size );
         state.realign();
-        state.template update_aligned< true >( _meta.template machinePointer< uint8_t >( i ), s );
+
+        if ( auto u = uniform( i ) )
+        {
+            /* same as hashing the flattened shadow in one go */
+            alignas( 8 ) uint8_t buf[ 32 ];
+            std::memset( buf, fill( u ), sizeof( buf ) );
+            for ( ; s > 32; s -= 32 )
+                state.template update_aligned< true >( buf, 32 ), state.mix();
+            state.template update_aligned< true >( buf, s );
+        }
+        else
+            state.template update_aligned< true >( _meta.template machinePointer< uint8_t >( i ), s );
+
         Next::hash( i, size, state, ptr_cb );
     }
 
-    using CompressedC = BitsetContainer< BPW, MetaPool >;
-    CompressedC compressed( Loc l, unsigned words ) const
+    bool plain( Internal i, int size ) const
+    {
+        if ( uniform( i ) )
+            return Next::plain( i, size );
+        for ( Compressed c : stored( Loc( i, 0, 0 ), ( size + 3 ) / 4 ) )
+            if ( !Next::is_trivial( c ) )
+                return false;
+        return Next::plain( i, size );
+    }
+
+    /* the shadow as stored, without regard to the uniform tag */
+    CompressedC stored( Loc l, unsigned words ) const
     {
         return CompressedC( _meta, l.object, l.offset / 4, words + l.offset / 4 );
     }
 
+    CompressedC compressed( Loc l, unsigned words ) const
+    {
+        flatten( l.object );
+        return stored( l, words );
+    }
+
     // Stores metadata from internal representation (value) to shadow memory (l).
     //
     // After successful execution of writes of lower layers, metadata layer
@@ -314,11 +480,29 @@ struct Metadata : Next
         else
             ASSERT_EQ( sz, 1 );
 
-        auto sh = compressed( l, words );
+        auto u = uniform( l.object );
         Expanded exp[ words ];
 
-        std::transform( sh.begin(), sh.end(), exp, Next::expand );
+        if ( u )
+            std::fill( exp, exp + words, Next::expand( fill( u ) ) );
+        else
+        {
+            auto sh = stored( l, words );
+            std::transform( sh.begin(), sh.end(), exp, Next::expand );
+        }
+
         Next::write( l, value, exp );
+
+        if ( u )
+        {
+            auto v = classify( exp, words );
+            if ( v == u )
+                return;
+            if ( v && l.offset == 0 && words == ( Next::_objects.size( l.object ) + 3 ) / 4 )
+                return uniform( l.object, v );
+        }
+
+        auto sh = compressed( l, words ); /* flattens the object if needed */
         std::transform( exp, exp + words, sh.begin(), Next::compress );
     }
 
@@ -340,10 +524,16 @@ struct Metadata : Next
         else
             ASSERT_EQ( sz, 1 );
 
-        auto sh = compressed( l, words );
         Expanded exp[ words ];
 
-        std::transform( sh.begin(), sh.end(), exp, Next::expand );
+        if ( auto u = uniform( l.object ) )
+            std::fill( exp, exp + words, Next::expand( fill( u ) ) );
+        else
+        {
+            auto sh = stored( l, words );
+            std::transform( sh.begin(), sh.end(), exp, Next::expand );
+        }
+
         Next::read( l, value, exp );
     }
 
@@ -384,9 +574,27 @@ struct Metadata : Next
         ASSERT_LT( 0, sz );
         const int words = ( sz + 3 ) / 4;
 
-        auto sh_from = from_h.compressed( from, words );
+        // The source object may be shared and must not be flattened. Copying
+        // a uniform source into a destination with the same tag, or over the
+        // whole of a uniform destination, does not touch the shadow at all.
+        auto u_from = from_h.uniform( from.object ), u_to = to_h.uniform( to.object );
+
+        if ( u_from && u_from != u_to && u_to &&
+             to.offset == 0 && sz == to_h._objects.size( to.object ) )
+            to_h.uniform( to.object, u_from );
+        else if ( u_from && u_from != u_to )
+            copy_shadow( from_h, from, UniformI{ fill( u_from ) }, to_h, to, sz );
+        else if ( !u_from )
+            copy_shadow( from_h, from, from_h.stored( from, words ).begin(), to_h, to, sz );
+
+        Next::copy( from_h, from, to_h, to, sz, internal );
+    }
+
+    template< typename FromH, typename I, typename ToH >
+    static void copy_shadow( FromH &from_h, typename FromH::Loc from, I i_from, ToH &to_h, Loc to, int sz )
+    {
+        const int words = ( sz + 3 ) / 4;
         auto sh_to = to_h.compressed( to, words );
-        auto i_from = sh_from.begin();
         auto i_to = sh_to.begin();
 
         int off = 0;
@@ -471,14 +679,15 @@ struct Metadata : Next
                 *i_to = Next::compress( exp_dst );
             }
         }
-
-        Next::copy( from_h, from, to_h, to, sz, internal );
     }
 
     bool tainted( Loc l, unsigned sz )
     {
+        if ( uniform( l.object ) )
+            return false;
+
         const int words = ( sz + 3 ) / 4;
-        auto i_meta = compressed( l, words ).begin();
+        auto i_meta = stored( l, words ).begin();
         int off = 0;
 
         // Aligned prefix
@@ -583,6 +792,16 @@ struct Metadata : Next
                     } while ( off % 4 );
                 }
 
+                if constexpr ( BPW == 8 )
+                {
+                    /* words before the last one preceding a candidate can be skipped */
+                    int word = off / 4, words = ( p.to + 3 ) / 4;
+                    int next = word + simd::find( p.compressed._base + word, words - word,
+                                                  Next::pointer_any, Next::pointer_all );
+                    if ( next - 1 > word )
+                        off += 4 * ( next - 1 - word );
+                }
+
                 while ( off < p.to &&
                         ! Next::is_pointer_or_exception( c_now() ) &&
                         ( ! ( off + 4 < p.to ) ||
@@ -620,7 +839,10 @@ struct Metadata : Next
         Next &layers;
         int from;
         int to;
+        bool uniform;
         iterator begin() {
+            if ( uniform ) /* no pointers */
+                return end();
             auto b = iterator( *this, from );
             if ( b.off % 4 && ! Next::is_pointer_exception( b.c_now() ) )
                 b.off = std::min( bitlevel::align( b.off, 4 ), to );
@@ -628,15 +850,16 @@ struct Metadata : Next
             return b;
         }
         iterator end() { return iterator( *this, to ); }
-        PointerC( MetaPool &p, Next &l, Internal i, int f, int t )
-            : compressed( p, i, 0, ( t + 3 ) / 4 ), obj( i ), layers( l ), from( f ), to( t )
+        PointerC( MetaPool &p, Next &l, Internal i, int f, int t, bool u )
+            : compressed( p, i, 0, ( t + 3 ) / 4 ), obj( i ), layers( l ), from( f ), to( t ),
+              uniform( u )
         {}
     };
 
     // Returns a range of pointers in the memory chunk from location 'l' of length 'sz'.
     auto pointers( Loc l, int sz )
     {
-        return PointerC( _meta, *this, l.object, l.offset, l.offset + sz );
+        return PointerC( _meta, *this, l.object, l.offset, l.offset + sz, uniform( l.object ) );
     }
 };
 
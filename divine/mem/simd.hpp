@@ -0,0 +1,211 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+
+/*
+ * (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+#include <brick-assert>
+
+#if defined( __x86_64__ ) && !defined( __divine__ )
+#include <immintrin.h>
+#endif
+
+/*
+ * Vectorised byte scans, used by the heap to skip over runs of words that
+ * need no special treatment (plain data with trivial metadata) when hashing,
+ * comparing and looking for pointers.
+ *
+ * A byte 'c' matches the pattern ( any, all ) if ( c & any ) != 0 or, unless
+ * 'all' is zero, if ( c & all ) == all. The scan returns the index of the
+ * first byte of 'a' that matches the pattern or differs from the byte at the
+ * same index in 'b' (if 'b' is given), or 'n' if there is no such byte. The
+ * AVX2 kernel is selected at runtime if the CPU supports it, SSE2 is always
+ * available on x86-64 and other platforms get a scalar loop.
+ */
+
+namespace divine::mem::simd
+{
+    namespace impl
+    {
+        using find_t = size_t (*)( const uint8_t *, const uint8_t *, size_t, uint8_t, uint8_t );
+
+        static inline bool match( uint8_t c, uint8_t any, uint8_t all )
+        {
+            return ( c & any ) || ( all && ( c & all ) == all );
+        }
+
+        static inline size_t find_scalar( const uint8_t *a, const uint8_t *b, size_t i, size_t n,
+                                          uint8_t any, uint8_t all )
+        {
+            for ( ; i < n; ++i )
+                if ( ( b && a[ i ] != b[ i ] ) || match( a[ i ], any, all ) )
+                    return i;
+            return n;
+        }
+
+        static inline size_t find_generic( const uint8_t *a, const uint8_t *b, size_t n,
+                                           uint8_t any, uint8_t all )
+        {
+            return find_scalar( a, b, 0, n, any, all );
+        }
+
+#if defined( __x86_64__ ) && !defined( __divine__ )
+        static inline size_t find_sse2( const uint8_t *a, const uint8_t *b, size_t n,
+                                        uint8_t any, uint8_t all )
+        {
+            const __m128i zero = _mm_setzero_si128(),
+                          v_any = _mm_set1_epi8( any ), v_all = _mm_set1_epi8( all );
+            size_t i = 0;
+
+            for ( ; i + 16 <= n; i += 16 )
+            {
+                auto v = _mm_loadu_si128( reinterpret_cast< const __m128i * >( a + i ) );
+                uint32_t hit = ~_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_and_si128( v, v_any ), zero ) );
+                if ( all )
+                    hit |= _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_and_si128( v, v_all ), v_all ) );
+                if ( b )
+                {
+                    auto w = _mm_loadu_si128( reinterpret_cast< const __m128i * >( b + i ) );
+                    hit |= ~_mm_movemask_epi8( _mm_cmpeq_epi8( v, w ) );
+                }
+                if ( hit &= 0xffff )
+                    return i + __builtin_ctz( hit );
+            }
+
+            return find_scalar( a, b, i, n, any, all );
+        }
+
+        [[gnu::target( "avx2" )]]
+        static inline size_t find_avx2( const uint8_t *a, const uint8_t *b, size_t n,
+                                        uint8_t any, uint8_t all )
+        {
+            const __m256i zero = _mm256_setzero_si256(),
+                          v_any = _mm256_set1_epi8( any ), v_all = _mm256_set1_epi8( all );
+            size_t i = 0;
+
+            for ( ; i + 32 <= n; i += 32 )
+            {
+                auto v = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( a + i ) );
+                uint32_t hit = ~_mm256_movemask_epi8(
+                                    _mm256_cmpeq_epi8( _mm256_and_si256( v, v_any ), zero ) );
+                if ( all )
+                    hit |= _mm256_movemask_epi8(
+                                _mm256_cmpeq_epi8( _mm256_and_si256( v, v_all ), v_all ) );
+                if ( b )
+                {
+                    auto w = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( b + i ) );
+                    hit |= ~_mm256_movemask_epi8( _mm256_cmpeq_epi8( v, w ) );
+                }
+                if ( hit )
+                    return i + __builtin_ctz( hit );
+            }
+
+            return find_sse2( a + i, b ? b + i : b, n - i, any, all ) + i;
+        }
+#endif
+
+        static inline find_t select()
+        {
+#if defined( __x86_64__ ) && !defined( __divine__ )
+            __builtin_cpu_init();
+            if ( __builtin_cpu_supports( "avx2" ) )
+                return find_avx2;
+            return find_sse2;
+#else
+            return find_generic;
+#endif
+        }
+    }
+
+    /* short arrays (the metadata of small objects) are not worth the call */
+    static inline size_t find( const uint8_t *a, const uint8_t *b, size_t n, uint8_t any, uint8_t all )
+    {
+        static const impl::find_t kernel = impl::select();
+        if ( n < 16 )
+            return impl::find_scalar( a, b, 0, n, any, all );
+        return kernel( a, b, n, any, all );
+    }
+
+    static inline size_t find( const uint8_t *a, size_t n, uint8_t any, uint8_t all )
+    {
+        return find( a, nullptr, n, any, all );
+    }
+
+    static inline size_t mismatch( const uint8_t *a, const uint8_t *b, size_t n )
+    {
+        return find( a, b, n, 0, 0 );
+    }
+}
+
+namespace divine::t_vm
+{
+
+struct SIMD
+{
+    uint8_t a[ 200 ], b[ 200 ];
+
+    SIMD()
+    {
+        for ( int i = 0; i < 200; ++i )
+            a[ i ] = b[ i ] = ( i * 37 ) & 0x1f;
+    }
+
+    template< typename F >
+    void check( F kernel )
+    {
+        for ( size_t n : { 0, 1, 15, 16, 17, 31, 32, 33, 64, 100, 200 } )
+        {
+            ASSERT_EQ( kernel( a, b, n, 0, 0 ), n );
+            ASSERT_EQ( kernel( a, nullptr, n, 0x80, 0x60 ), n );
+
+            for ( size_t i = 0; i < n; i += 7 )
+            {
+                b[ i ] ^= 1;
+                ASSERT_EQ( kernel( a, b, n, 0, 0 ), i );
+                b[ i ] ^= 1;
+
+                a[ i ] |= 0x80, b[ i ] |= 0x80;
+                ASSERT_EQ( kernel( a, b, n, 0x80, 0 ), i );
+                ASSERT_EQ( kernel( a, b, n, 0, 0 ), n );
+                a[ i ] &= 0x7f, b[ i ] &= 0x7f;
+
+                a[ i ] |= 0x40;
+                ASSERT_EQ( kernel( a, nullptr, n, 0, 0x60 ), n );
+                a[ i ] |= 0x20;
+                ASSERT_EQ( kernel( a, nullptr, n, 0, 0x60 ), i );
+                a[ i ] &= 0x1f;
+            }
+        }
+    }
+
+    TEST( generic ) { check( mem::simd::impl::find_generic ); }
+    TEST( dispatch ) { check( []( auto... args ) { return mem::simd::find( args... ); } ); }
+
+#if defined( __x86_64__ ) && !defined( __divine__ )
+    TEST( sse2 ) { check( mem::simd::impl::find_sse2 ); }
+    TEST( avx2 )
+    {
+        if ( __builtin_cpu_supports( "avx2" ) )
+            check( mem::simd::impl::find_avx2 );
+    }
+#endif
+};
+
+}
@@ -0,0 +1,163 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+
+/*
+ * (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <brick-hash>
+#include <brick-hashset>
+#include <cstring>
+#include <vector>
+
+namespace divine::mem
+{
+    /*
+     * Tree compression (recursive hash-consing) of snapshots. The (sorted)
+     * array of snapshot items is split into a binary tree: leaves hold at most
+     * two items and inner nodes hold pointers to their two children. The left
+     * subtree always covers the largest power of two items that is strictly
+     * less than the total, so that the shape only depends on the item count
+     * and a change in one object only touches a single root-to-leaf path.
+     *
+     * Each node lives in the snapshot pool and is interned in a concurrent
+     * hash table, which means that identical subtrees are stored exactly once
+     * and the snapshot itself shrinks into a fixed-size root record. Since
+     * equal arrays always yield the same root, two snapshots can be compared
+     * without expanding them. Nodes are never freed.
+     */
+
+    template< typename Pool, typename Item >
+    struct Tree
+    {
+        using Node = typename Pool::Pointer;
+        using Snapshot = typename Pool::Pointer;
+        using Table = brq::concurrent_hash_set< Node >;
+
+        struct Root
+        {
+            Node node;
+            int32_t count;
+        };
+
+        struct Hasher : brq::hash_adaptor< Node >
+        {
+            Pool &_pool;
+            Hasher( Pool &p ) : _pool( p ) {}
+
+            hash64_t hash( Node n ) const
+            {
+                return brq::hash( _pool.template machinePointer< uint8_t >( n ), _pool.size( n ) );
+            }
+
+            template< typename Cell >
+            typename Cell::pointer match( Cell &cell, Node x, hash64_t h ) const
+            {
+                if ( !cell.match( h ) )
+                    return nullptr;
+
+                auto a = cell.fetch();
+                int size = _pool.size( a );
+                if ( _pool.size( x ) != size )
+                    return nullptr;
+                if ( std::memcmp( _pool.dereference( a ), _pool.dereference( x ), size ) )
+                    return nullptr;
+
+                return cell.value();
+            }
+        };
+
+        static int split( int count )
+        {
+            ASSERT_LEQ( 3, count );
+            return 1 << ( 31 - __builtin_clz( count - 1 ) );
+        }
+
+        static Node intern( Pool &p, Table &t, const void *data, int size )
+        {
+            auto n = p.allocate( size );
+            std::memcpy( p.dereference( n ), data, size );
+
+            Node r = t.insert( n, Hasher( p ) )->load();
+            if ( r != n )
+                p.free( n );
+            r.tag( 0 ); /* strip the hash bits of the table cell */
+            return r;
+        }
+
+        static Node build( Pool &p, Table &t, const Item *items, int count )
+        {
+            if ( count <= 2 )
+                return intern( p, t, items, count * sizeof( Item ) );
+
+            int left = split( count );
+            Node kids[ 2 ] = { build( p, t, items, left ),
+                               build( p, t, items + left, count - left ) };
+            return intern( p, t, kids, sizeof( kids ) );
+        }
+
+        static void expand( Pool &p, Node n, int count, Item *out )
+        {
+            if ( count <= 2 )
+                return void( std::memcpy( out, p.dereference( n ), count * sizeof( Item ) ) );
+
+            int left = split( count );
+            Node kids[ 2 ];
+            std::memcpy( kids, p.dereference( n ), sizeof( kids ) );
+            expand( p, kids[ 0 ], left, out );
+            expand( p, kids[ 1 ], count - left, out + left );
+        }
+
+        static Root &root( Pool &p, Snapshot s ) { return *p.template machinePointer< Root >( s ); }
+        static int count( Pool &p, Snapshot s ) { return root( p, s ).count; }
+
+        /* The root node may be replaced (see Cow::freeze) while other threads
+         * read the snapshot, hence the atomic access. */
+        static Node node( Pool &p, Snapshot s )
+        {
+            Node n;
+            __atomic_load( &root( p, s ).node, &n, __ATOMIC_SEQ_CST );
+            return n;
+        }
+
+        static bool replace( Pool &p, Snapshot s, Node old, Node n )
+        {
+            return __atomic_compare_exchange( &root( p, s ).node, &old, &n, false,
+                                              __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+        }
+
+        static Snapshot compress( Pool &p, Table &t, const Item *items, int count )
+        {
+            ASSERT_LT( 0, count );
+            auto s = p.allocate( sizeof( Root ) );
+            root( p, s ).node = build( p, t, items, count );
+            root( p, s ).count = count;
+            return s;
+        }
+
+        static void expand( Pool &p, Snapshot s, std::vector< Item > &out )
+        {
+            out.resize( count( p, s ) );
+            expand( p, node( p, s ), count( p, s ), out.data() );
+        }
+
+        static bool equal( Pool &p, Snapshot a, Snapshot b )
+        {
+            return root( p, a ).count == root( p, b ).count &&
+                   node( p, a ) == node( p, b );
+        }
+    };
+}
@@ -87,6 +87,11 @@ struct UserMeta : Next
         Next::free( p );
     }
 
+    bool plain( Internal p, int size ) const
+    {
+        return !_maps._storage.snapped( p ) && Next::plain( p, size );
+    }
+
     std::tuple< int, int, Value > peek( Loc l, int len, int layer )
     {
         if ( auto *p = _maps.intersect( l.object, { l.offset, layer }, len ) )
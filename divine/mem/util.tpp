@@ -95,7 +95,9 @@ namespace divine::mem
     {
         template< typename T > void update_aligned( T ) {}
         template< bool = false > void update_aligned( uint8_t *, size_t ) {}
+        template< bool = false > void update( const uint8_t *, int ) {}
         void realign() {}
+        void mix() {}
         hash64_t hash() const { return 0; }
     };
 
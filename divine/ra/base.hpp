@@ -76,10 +76,27 @@ namespace divine::ra {
             return std::make_shared< _BitCode >( llvm::CloneModule( *_m ), _ctx, _bc_opts );
         }
 
+        /* Link the DiOS runtime into _m up front, instead of in each iteration
+         * (make_bc then only needs to run the LART passes and compute the
+         * program). The linker uses _m as its composite module, hence the
+         * module (and any pointers into it) stays the same. */
+        void link_dios()
+        {
+            mc::BitCode bc( std::move( _m ), _ctx );
+            bc.set_options( _bc_opts );
+            bc.do_dios();
+            _m = std::move( bc._module );
+        }
+
         template< template<typename, typename> class job_t = divine::mc::Safety >
-        auto run() {
+        auto run() { return run< job_t >( []( auto &, auto * ) {} ); }
+
+        /* 'setup' is called with the job and the bitcode before the search starts */
+        template< template<typename, typename> class job_t = divine::mc::Safety, typename Setup >
+        auto run( Setup setup ) {
             auto bc = make_bc();
             auto safe = mc::make_job< job_t >( bc, ss::passive_listen() );
+            setup( *safe, bc.get() );
             // FIXME: thread_count
             safe->start( 1 );
             safe->wait();
@@ -15,6 +15,8 @@
  */
 #include <divine/ra/llvmrefine.hpp>
 
+#include <algorithm>
+
 namespace divine::ra {
 
     void ce_t::_create_ctx( dbg_ctx_t &dbg_ctx, mc::Job &job )
@@ -24,10 +26,16 @@ namespace divine::ra {
         if ( job.result() == mc::Result::BootError )
             UNREACHABLE( "Refinement encountered an unexpected boot error." );
 
+        _create_ctx( dbg_ctx, job, trace.final, trace.steps.back() );
+    }
+
+    void ce_t::_create_ctx( dbg_ctx_t &dbg_ctx, mc::Job &job,
+                            vm::CowSnapshot from, const vm::Step &step )
+    {
         job.dbg_fill( dbg_ctx );
-        dbg_ctx.load( trace.final );
+        dbg_ctx.load( from );
 
-        dbg_ctx._lock = trace.steps.back();
+        dbg_ctx._lock = step;
         dbg_ctx._lock_mode = dbg_ctx_t::LockBoth;
         vm::setup::scheduler( dbg_ctx );
         using Stepper = dbg::Stepper< dbg_ctx_t >;
@@ -51,9 +59,9 @@ namespace divine::ra {
         return out;
     }
 
-    void remove_indirect_calls::enhance( ce_t &counter_example )
+    auto remove_indirect_calls::target( ce_t &counter_example ) -> target_t
     {
-        std::optional< std::pair< llvm::Function *, llvm::Function * > > target;
+        target_t target;
         auto gather = [ & ]( auto frame, auto &heap, auto &info )
         {
             if ( target ) return;
@@ -73,10 +81,41 @@ namespace divine::ra {
         };
 
         counter_example.stack_trace( gather );
-        ASSERT( target );
+        return target;
+    }
+
+    void remove_indirect_calls::enhance( ce_t &counter_example )
+    {
+        auto t = target( counter_example );
+        ASSERT( t );
 
-        auto [ where, callee ] = *target;
+        auto [ where, callee ] = *t;
         llvm_pass.enhance( where, callee );
     }
 
+    bool remove_indirect_calls::absorb( ce_t &counter_example )
+    {
+        auto t = target( counter_example );
+        if ( !t || !t->second )
+            return false;
+
+        std::lock_guard< std::mutex > lock( _pending_mutex );
+        if ( std::find( _pending.begin(), _pending.end(), *t ) == _pending.end() )
+            _pending.push_back( *t );
+        return true;
+    }
+
+    /* the functions in _pending belong to the module of the current iteration,
+     * which must be still alive at this point */
+    bool remove_indirect_calls::flush()
+    {
+        std::lock_guard< std::mutex > lock( _pending_mutex );
+        for ( auto [ where, callee ] : _pending )
+            llvm_pass.enhance( where, callee );
+
+        bool refined = !_pending.empty();
+        _pending.clear();
+        return refined;
+    }
+
 }
@@ -16,6 +16,9 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 #include <bricks/brick-assert>
 #include <bricks/brick-llvm>
@@ -52,7 +55,17 @@ namespace divine::ra {
             _create_ctx( dbg_ctx, job );
         }
 
+        /* the error edge from 'from' along 'step', without a full trace */
+        ce_t( mc::Job &job, mc::BitCode *bc, vm::CowSnapshot from, const vm::Step &step )
+            : info( *bc->_program, *bc->_module ),
+              dbg_ctx( bc->program(), bc->debug() )
+        {
+            _create_ctx( dbg_ctx, job, from, step );
+        }
+
         void _create_ctx( dbg_ctx_t &dbg_ctx, mc::Job &job );
+        void _create_ctx( dbg_ctx_t &dbg_ctx, mc::Job &job,
+                          vm::CowSnapshot from, const vm::Step &step );
 
         stack_trace_t stack_trace();
 
@@ -95,16 +108,22 @@ namespace divine::ra {
 
         refiner_t _refiner;
 
+        int _iterations = 0;
+
         llvm_refinement( std::shared_ptr< llvm::LLVMContext > ctx,
                          std::unique_ptr< llvm::Module > m,
                          const BCOptions &bc_opts )
             : refinement_t( std::move( ctx ), std::move( m ), bc_opts ),
              _refiner( *_m )
-        {}
+        {
+            link_dios();
+        }
 
         llvm_refinement( const BCOptions &bc_opts )
             : refinement_t( bc_opts ), _refiner( *_m )
-        {}
+        {
+            link_dios();
+        }
 
         bool iterate( uint64_t n )
         {
@@ -119,13 +138,24 @@ namespace divine::ra {
             while ( !iterate() ) {}
         }
 
+        /* Errors which the refiner can fix are collected without stopping the
+         * search, so a single exploration finds all of them that are reachable
+         * in the current program, not just the first one. A new iteration is
+         * only needed for those that are hidden behind the fixed ones. An
+         * error the refiner cannot fix ends the refinement. */
         bool iterate() {
-            auto [ result, bc ] = this->run();
-            if ( result->result() == mc::Result::Valid )
-                return true;
-            ce_t ce( *result, bc.get() );
-            _refiner.enhance( ce );
-            return false;
+            ++ _iterations;
+            auto absorb = [&]( mc::Job &job, mc::BitCode *bc )
+            {
+                job.error_filter( [&, bc]( auto from, auto &step )
+                {
+                    ce_t ce( job, bc, from, step );
+                    return _refiner.absorb( ce );
+                } );
+            };
+
+            auto [ result, bc ] = this->run( absorb );
+            return !_refiner.flush() || result->result() != mc::Result::Valid;
         }
 
         std::string report() { _refiner.report(); }
@@ -140,7 +170,17 @@ namespace divine::ra {
             llvm_pass.init();
         }
 
+        /* missing call targets found in the current iteration, in order of
+         * discovery; absorb() is called from the search threads */
+        std::vector< std::pair< llvm::Function *, llvm::Function * > > _pending;
+        std::mutex _pending_mutex;
+
+        using target_t = std::optional< std::pair< llvm::Function *, llvm::Function * > >;
+        target_t target( ce_t &counter_example );
+
         void enhance( ce_t &counter_example );
+        bool absorb( ce_t &counter_example );
+        bool flush();
 
         std::string report() { return llvm_pass.report(); }
     };
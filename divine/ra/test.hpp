@@ -144,6 +144,39 @@ namespace divine::t_ra {
             auto callees = to_names( info.begin()->second );
             ASSERT( callees == names_t{ "boo", "goo" } );
         }
+
+        TEST( independent_targets )
+        {
+            auto src = R"(
+                #include <sys/divm.h>
+                extern "C" {
+                    #define N __attribute__((__noinline__))
+                    N void boo() { return; }
+                    N void foo() { return; }
+                    N void goo() { return; }
+
+                    N void dispatch( void(*f)() ) { f(); }
+                }
+
+                int main()
+                {
+                    switch ( __vm_choose( 3 ) )
+                    {
+                        case 0: dispatch( boo ); break;
+                        case 1: dispatch( foo ); break;
+                        case 2: dispatch( goo ); break;
+                    }
+                }
+            )";
+            auto refiner = build( src );
+            refiner.finish();
+            auto info = refiner._refiner.llvm_pass.info();
+            ASSERT( info.size() == 1 );
+            auto callees = to_names( info.begin()->second );
+            ASSERT( callees == names_t{ "boo", "foo", "goo" } );
+            /* all three are found by the first search, the second one checks */
+            ASSERT_EQ( refiner._iterations, 2 );
+        }
     };
 
 } // namespace t_ra
@@ -3,16 +3,27 @@
 
 DIVINE_RELAX_WARNINGS
 #include <llvm/IR/Module.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Support/MemoryBuffer.h>
 DIVINE_UNRELAX_WARNINGS
 
 #include <brick-fs>
+#include <brick-hash>
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
 
 namespace divine {
 namespace rt {
 
 using namespace cc;
 
-void DiosCC::link_dios_config( std::string n, std::string lamp )
+void DiosCC::link_dios_runtime( std::string n, std::string lamp )
 {
     linkEntireArchive( "rst" );
     auto mod = load_object( find_object( "config/" + n ) );
@@ -29,6 +40,139 @@ void DiosCC::link_dios_config( std::string n, std::string lamp )
     }
 }
 
+/* The part of the runtime that does not depend on the program -- 'rst', the
+ * config (and lamp) objects and the library members they pull in -- is the
+ * same on every run with the same configuration. It is therefore linked only
+ * once and kept as bitcode, both in memory and in the cache directory
+ * ($DIVINE_CACHE, $XDG_CACHE_HOME/divine or ~/.cache/divine; an empty
+ * DIVINE_CACHE disables the on-disk copy). Files are named after a hash of
+ * the embedded runtime, so a rebuilt divine never picks up a stale one. */
+
+static std::string cache_dir()
+{
+    if ( auto d = std::getenv( "DIVINE_CACHE" ) )
+        return d;
+    if ( auto d = std::getenv( "XDG_CACHE_HOME" ); d && *d )
+        return brq::join_path( d, "divine" );
+    if ( auto d = std::getenv( "HOME" ); d && *d )
+        return brq::join_path( d, ".cache", "divine" );
+    return "";
+}
+
+static std::string runtime_key( std::string cfg, std::string lamp )
+{
+    static const brq::hash64_t sum = []
+    {
+        brq::hash64_t h = 0;
+        auto add = [&]( auto s ) { h = brq::hash( reinterpret_cast< const uint8_t * >( s.data() ),
+                                                  s.size(), h ); };
+        each( [&]( std::string n, std::string_view c ) { add( n ), add( c ); } );
+        return h;
+    }();
+
+    std::stringstream key;
+    key << "runtime-" << cfg << ( lamp.empty() ? "" : "-" + lamp ) << "-" << std::hex << sum << ".bc";
+    return key.str();
+}
+
+/* With 'rebuild' set, the copy we have (most likely a damaged file) is not
+ * used: the runtime is linked anew and the file is replaced. */
+
+llvm::MemoryBufferRef DiosCC::prelinked_runtime( std::string cfg, std::string lamp, bool rebuild )
+{
+    static std::mutex mutex;
+    static std::map< std::string, std::unique_ptr< llvm::MemoryBuffer > > cache;
+    static std::vector< std::unique_ptr< llvm::MemoryBuffer > > retired;
+
+    std::lock_guard< std::mutex > lock( mutex );
+    auto key = runtime_key( cfg, lamp );
+    auto &buf = cache[ key ];
+
+    if ( buf && rebuild ) /* other threads may still be reading it */
+        retired.push_back( std::move( buf ) );
+
+    if ( buf )
+        return buf->getMemBufferRef();
+
+    auto dir = cache_dir(), path = dir.empty() ? "" : brq::join_path( dir, key );
+
+    if ( !path.empty() && !rebuild )
+        if ( auto file = llvm::MemoryBuffer::getFile( path ) )
+            return ( buf = std::move( file.get() ) )->getMemBufferRef();
+
+    DiosCC drv( std::make_shared< llvm::LLVMContext >() );
+    drv.link_dios_runtime( cfg, lamp );
+    buf = llvm::MemoryBuffer::getMemBufferCopy( drv.serialize(), key );
+
+    if ( !path.empty() )
+        try
+        {
+            /* write a private copy and rename it, so that concurrent runs
+             * never see a partial file */
+            auto tmp = path + "." + std::to_string( ::getpid() );
+            brq::create_dir( dir );
+            std::ofstream out( tmp, std::ios::binary | std::ios::trunc );
+            out.write( buf->getBufferStart(), buf->getBufferSize() );
+            out.close();
+            if ( !out || std::rename( tmp.c_str(), path.c_str() ) )
+                std::remove( tmp.c_str() );
+        }
+        catch ( std::exception & ) {} /* the cache is only an optimisation */
+
+    return buf->getMemBufferRef();
+}
+
+/* The prelinked runtime can only replace the original sequence of links if
+ * no program symbol would have stopped a library member from being pulled in:
+ * a strong definition in the runtime that the program also defines means the
+ * outcome could differ (or it is a genuine clash, which the slow path will
+ * report the usual way). */
+
+static bool overrides_runtime( llvm::Module &prog, llvm::Module &runtime )
+{
+    for ( auto &g : runtime.global_values() )
+        if ( !g.isDeclaration() && !g.hasLocalLinkage() && !g.isWeakForLinker() )
+            if ( auto p = prog.getNamedValue( g.getName() ); p && !p->isDeclaration() )
+                return true;
+    return false;
+}
+
+/* The prelinked module is parsed in full: all of it ends up in the program,
+ * just like the entire 'rst' archive did. If the cached copy cannot be
+ * parsed, it is treated as a miss and replaced. */
+
+void DiosCC::link_dios_config( std::string n, std::string lamp )
+{
+    auto parse = [&]( bool rebuild )
+    {
+        return llvm::parseBitcodeFile( prelinked_runtime( n, lamp, rebuild ), *context() );
+    };
+
+    auto mod = parse( false );
+    if ( !mod )
+    {
+        llvm::consumeError( mod.takeError() );
+        mod = parse( true );
+    }
+
+    if ( !mod )
+        brq::raise() << "could not parse the prelinked runtime " << runtime_key( n, lamp )
+                     << ": " << llvm::toString( mod.takeError() );
+
+    if ( linker->hasModule() && overrides_runtime( *linker->get(), *mod.get() ) )
+        return link_dios_runtime( n, lamp );
+
+    link( std::move( mod.get() ) );
+
+    /* resolve whatever else the program needs from the libraries */
+    for ( int i = 0; i < 3; ++i )
+    {
+        linkLib( "dios" );
+        linkLib( "dios_divm" );
+        linkLibs( rt::DiosCC::defaultDIVINELibs );
+    }
+}
+
 void add_dios_header_paths( std::vector< std::string >& paths )
 {
     paths.insert( paths.end(),
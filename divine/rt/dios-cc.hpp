@@ -26,7 +26,12 @@ struct DiosCC : cc::Driver
 
     void setup( Options opts ) { this->opts = opts; }
 
+    /* link the runtime for the given configuration into the program; uses
+     * a cached, prelinked copy of the program-independent part */
     void link_dios_config( std::string cfg, std::string lamp = "" );
+    void link_dios_runtime( std::string cfg, std::string lamp = "" );
+    static llvm::MemoryBufferRef prelinked_runtime( std::string cfg, std::string lamp,
+                                                    bool rebuild = false );
     void build( cc::ParsedOpts po );
 };
 
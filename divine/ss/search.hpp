@@ -5,10 +5,17 @@
 #include <future>
 #include <vector>
 #include <stack>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <thread>
+#include <random>
 
 #include <brick-shmem>
+#include <brick-timer>
 
 /* tests */
+#include <map>
 #include <divine/ss/listen.hpp>
 #include <divine/ss/fixed.hpp>
 #include <divine/ss/random.hpp>
@@ -18,6 +25,9 @@ namespace ss {
 
 namespace shmem = ::brick::shmem;
 
+struct wait_timer_tag;
+using wait_timer = brq::timer< wait_timer_tag >; /* only active with brq::profiling */
+
 struct Job
 {
     virtual void start( int threads ) = 0;
@@ -26,7 +36,82 @@ struct Job
     std::function< int64_t() > qsize;
 };
 
-enum class Order { PseudoBFS, DFS };
+enum class Order { PseudoBFS, BFS, BestFirst, DFS };
+
+/* A relaxed concurrent priority queue (a 'multiqueue'): a number of locked
+ * binary heaps, a push goes into a random one, a pop takes the better of the
+ * tops of two random heaps. The order is only approximate, but the heaps are
+ * rarely contended. Items with equal priority come out in FIFO order. */
+
+template< typename T >
+struct PriorityQueue
+{
+    struct Item
+    {
+        int64_t prio;
+        uint64_t seq;
+        T value;
+        bool operator<( const Item &o ) const
+        {
+            return prio < o.prio || ( prio == o.prio && seq > o.seq );
+        }
+    };
+
+    struct alignas( 64 ) Heap
+    {
+        std::mutex mutex;
+        std::priority_queue< Item > heap;
+        std::atomic< int64_t > top = std::numeric_limits< int64_t >::min();
+
+        void update()
+        {
+            top = heap.empty() ? std::numeric_limits< int64_t >::min() : heap.top().prio;
+        }
+    };
+
+    std::unique_ptr< Heap[] > _heaps;
+    int _count;
+    std::atomic< uint64_t > _seq = 0;
+    std::atomic< int64_t > _size = 0;
+
+    PriorityQueue( int count ) : _heaps( new Heap[ count ] ), _count( count ) {}
+
+    template< typename R >
+    void push( const T &v, int64_t prio, R &rand )
+    {
+        auto &h = _heaps[ rand() % _count ];
+        std::lock_guard< std::mutex > lock( h.mutex );
+        h.heap.push( Item{ prio, _seq++, v } );
+        h.update();
+        ++ _size;
+    }
+
+    bool pop( Heap &h, T &v )
+    {
+        std::lock_guard< std::mutex > lock( h.mutex );
+        if ( h.heap.empty() )
+            return false;
+        v = h.heap.top().value;
+        h.heap.pop();
+        h.update();
+        -- _size;
+        return true;
+    }
+
+    template< typename R >
+    bool pop( T &v, R &rand )
+    {
+        auto &a = _heaps[ rand() % _count ], &b = _heaps[ rand() % _count ];
+        if ( pop( a.top >= b.top ? a : b, v ) )
+            return true;
+        for ( int i = 0; i < _count; ++i ) /* the sampled heaps were empty */
+            if ( pop( _heaps[ i ], v ) )
+                return true;
+        return false;
+    }
+
+    int64_t size() const { return _size; }
+};
 
 template< typename B, typename L >
 struct Search : Job
@@ -141,6 +226,7 @@ struct Search : Job
                 {
                     if ( queue.empty() )
                     {
+                        wait_timer _timer( brq::profiling );
                         queue.flush();
                         work.sync();
                         continue;
@@ -160,6 +246,154 @@ struct Search : Job
         };
     }
 
+    /* A level-synchronous BFS: all threads share the current frontier and
+     * collect successors into the next one; a new level only starts once
+     * the previous one is fully explored. Unlike pseudoBFS, each state is
+     * first reached (and hence given a parent) by a shortest path. */
+    struct Level
+    {
+        std::vector< State > frontier, next;
+        std::atomic< size_t > index = 0, queued = 0;
+        std::mutex mutex;
+        std::condition_variable cond;
+        int arrived = 0;
+        unsigned generation = 0;
+    };
+
+    /* the last thread to arrive starts the next level, returns false when
+     * there is nothing left to explore */
+    bool _next_level( Level &lvl, int threads )
+    {
+        wait_timer _timer( brq::profiling );
+        std::unique_lock< std::mutex > lock( lvl.mutex );
+
+        if ( ++ lvl.arrived == threads )
+        {
+            lvl.frontier.swap( lvl.next );
+            lvl.next.clear();
+            lvl.index = 0;
+            lvl.queued = lvl.frontier.size();
+            lvl.arrived = 0;
+            ++ lvl.generation;
+            lvl.cond.notify_all();
+        }
+        else
+        {
+            auto gen = lvl.generation;
+            while ( gen == lvl.generation && !_terminate->load() )
+                lvl.cond.wait_for( lock, std::chrono::milliseconds( 100 ) );
+        }
+
+        return !lvl.frontier.empty() && !_terminate->load();
+    }
+
+    Worker BFS()
+    {
+        auto lvl = std::make_shared< Level >();
+        shmem::StartDetector start;
+
+        qsize = [=]() { return int64_t( lvl->queued ) - int64_t( lvl->index ); };
+
+        auto builder = _builder;
+        auto listener = _listener;
+
+        _initials( listener, builder, [&]( auto st ) { lvl->frontier.push_back( st ); } );
+        lvl->queued = lvl->frontier.size();
+
+        return [=]() mutable
+        {
+            auto _reg = _register( builder, listener );
+            start.waitForAll( _thread_count );
+            brick::types::Defer _( [&]()
+            {
+                _terminate->store( true );
+                std::lock_guard< std::mutex > lock( lvl->mutex );
+                lvl->cond.notify_all();
+            } );
+
+            std::vector< State > next;
+
+            try {
+                do {
+                    size_t i;
+                    while ( ( i = lvl->index++ ) < lvl->frontier.size() && !_terminate->load() )
+                        _succs( listener, builder, lvl->frontier[ i ],
+                                [&]( auto s, auto, bool isnew )
+                                {
+                                    _state( listener, s, isnew,
+                                            [&]( bool ) { next.push_back( s ); } );
+                                } );
+
+                    std::lock_guard< std::mutex > lock( lvl->mutex );
+                    lvl->next.insert( lvl->next.end(), next.begin(), next.end() );
+                    next.clear();
+                } while ( _next_level( *lvl, _thread_count ) );
+            } catch ( Terminate ) {}
+        };
+    }
+
+    /* A parallel best-first search, driven by the heuristic (which scores
+     * each edge by its target and label). Useful for finding errors early,
+     * without exploring the entire state space first. */
+    using Heuristic = std::function< int64_t( const State &, const Label & ) >;
+    Heuristic _heuristic;
+
+    void heuristic( Heuristic h ) { _heuristic = h; }
+
+    Worker bestFirst()
+    {
+        using Queue = PriorityQueue< State >;
+        auto queue = std::make_shared< Queue >( 2 * _thread_count );
+        auto work = std::make_shared< std::atomic< int64_t > >( 0 );
+        shmem::StartDetector start;
+        std::minstd_rand rand;
+
+        qsize = [=]() { return queue->size(); };
+
+        auto builder = _builder;
+        auto listener = _listener;
+
+        _initials( listener, builder, [&]( auto st )
+        {
+            ++ *work;
+            queue->push( st, std::numeric_limits< int64_t >::max(), rand );
+        } );
+
+        return [=]() mutable
+        {
+            auto _reg = _register( builder, listener );
+            start.waitForAll( _thread_count );
+            brick::types::Defer _( [&]() { _terminate->store( true ); } );
+            rand.seed( std::hash< std::thread::id >()( std::this_thread::get_id() ) );
+            State v;
+
+            try {
+                while ( !_terminate->load() )
+                {
+                    if ( !queue->pop( v, rand ) )
+                    {
+                        if ( !work->load() )
+                            break;
+                        wait_timer _timer( brq::profiling );
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    _succs( listener, builder, v,
+                            [&]( auto s, auto l, bool isnew )
+                            {
+                                _state( listener, s, isnew, [&]( bool )
+                                {
+                                    ++ *work;
+                                    queue->push( s, _heuristic ? _heuristic( s, l ) : 0, rand );
+                                } );
+                            } );
+                    -- *work;
+                }
+            } catch ( Terminate ) {}
+        };
+    }
+
     struct DFSItem
     {
         enum Type { Pre, Post } type;
@@ -210,6 +444,8 @@ struct Search : Job
         switch ( _order )
         {
             case Order::PseudoBFS: blueprint = pseudoBFS(); break;
+            case Order::BFS: blueprint = BFS(); break;
+            case Order::BestFirst: blueprint = bestFirst(); break;
             case Order::DFS: blueprint = DFS(); break;
         }
 
@@ -308,6 +544,74 @@ struct Search
     TEST( dfs_fixed ) { _fixed( ss::Order::DFS, 1 ); }
     TEST( dfs_random ) { _random( ss::Order::DFS, 1 ); }
 
+    TEST( level_fixed ) { _fixed( ss::Order::BFS, 1 ); }
+    TEST( level_random ) { _random( ss::Order::BFS, 1 ); }
+
+    TEST( level_parallel )
+    {
+        _fixed( ss::Order::BFS, 3 );
+        _random( ss::Order::BFS, 2 );
+        _random( ss::Order::BFS, 3 );
+    }
+
+    TEST( level_shortest )
+    {
+        /* a long chain 1 → … → N + 1 with a shortcut 1 → N + 2 → N + 1 */
+        std::vector< std::pair< int, int > > vec;
+        for ( int i = 1; i <= N; ++i )
+            vec.emplace_back( i, i + 1 );
+        vec.emplace_back( 1, N + 2 );
+        vec.emplace_back( N + 2, N + 1 );
+
+        for ( int threads : { 1, 3 } )
+        {
+            ss::Fixed builder( vec );
+            std::mutex mutex;
+            std::map< int, int > depth{ { 1, 0 } };
+            ss::search(
+                ss::Order::BFS, builder, threads, ss::passive_listen(
+                    [&] ( auto f, auto t, auto, bool isnew )
+                    {
+                        std::lock_guard< std::mutex > lock( mutex );
+                        if ( isnew )
+                            depth[ t ] = depth[ f ] + 1;
+                    },
+                    [&]( auto ) {} ) );
+            ASSERT_EQ( depth[ N + 1 ], 2 );
+            ASSERT_EQ( depth[ N ], N - 1 );
+        }
+    }
+
+    TEST( best_fixed ) { _fixed( ss::Order::BestFirst, 1 ); }
+    TEST( best_random ) { _random( ss::Order::BestFirst, 1 ); }
+
+    TEST( best_parallel )
+    {
+        _fixed( ss::Order::BestFirst, 3 );
+        _random( ss::Order::BestFirst, 2 );
+        _random( ss::Order::BestFirst, 3 );
+    }
+
+    TEST( best_directed )
+    {
+        /* a binary tree of depth 12, the goal is the rightmost leaf */
+        std::vector< std::pair< int, int > > vec;
+        for ( int i = 1; i < 4096; ++i )
+            vec.emplace_back( i, 2 * i ), vec.emplace_back( i, 2 * i + 1 );
+
+        ss::Fixed builder( vec );
+        int found = 0;
+        auto s = ss::make_search( builder, ss::listen(
+            [&] ( auto, auto t, auto ) { return t == 8191 ? ss::Listen::Terminate
+                                                          : ss::Listen::AsNeeded; },
+            [&]( auto ) { ++found; return ss::Listen::AsNeeded; } ) );
+        s.order( ss::Order::BestFirst );
+        s.heuristic( []( int st, int ) { return st % 2 ? 1 : 0; } );
+        s.start( 1 );
+        s.wait();
+        ASSERT_LT( found, 100 );
+    }
+
     TEST( bfs_fixed_parallel )
     {
         _fixed( ss::Order::PseudoBFS, 2 );
@@ -33,6 +33,7 @@
 
 #include <brick-cmd>
 #include <brick-fs>
+#include <brick-mem>
 #include <brick-string>
 #include <cctype>
 #include <regex>
@@ -68,6 +69,13 @@ namespace divine::ui::arg
     };
 
     enum class report { none, yaml, yaml_long };
+    enum class metrics { jsonl, prometheus };
+    enum class fairness { none /* not given */, dios, weak, strong };
+
+    struct backing : brick::mem::Backing
+    {
+        static auto help() { return "mmap, thp or hugetlb, optionally followed by ,release"; }
+    };
 
     static brq::parse_result from_string( std::string_view s, mem &m )
     {
@@ -162,6 +170,40 @@ namespace divine::ui::arg
         else return brq::no_parse( "report type must be none, yaml or yaml-long" );
         return {};
     }
+
+    static brq::parse_result from_string( std::string_view s, metrics &m )
+    {
+        if      ( s == "jsonl" ) m = metrics::jsonl;
+        else if ( s == "prometheus" ) m = metrics::prometheus;
+        else return brq::no_parse( "metrics format must be jsonl or prometheus" );
+        return {};
+    }
+
+    static brq::parse_result from_string( std::string_view s, fairness &f )
+    {
+        if      ( s == "dios" ) f = fairness::dios;
+        else if ( s == "weak" ) f = fairness::weak;
+        else if ( s == "strong" ) f = fairness::strong;
+        else return brq::no_parse( "fairness must be dios, weak or strong" );
+        return {};
+    }
+
+    static brq::parse_result from_string( std::string_view s, backing &b )
+    {
+        using mode = brick::mem::Backing::Mode;
+        b = backing();
+
+        for ( auto str : brq::splitter( s, ',' ) )
+        {
+            if      ( str == "mmap" ) b.mode = mode::Plain;
+            else if ( str == "thp" ) b.mode = mode::THP;
+            else if ( str == "hugetlb" ) b.mode = mode::HugeTLB;
+            else if ( str == "release" ) b.release = true;
+            else return brq::no_parse( "pool backing must be mmap, thp or hugetlb (+ release)" );
+        }
+
+        return {};
+    }
 }
 
 namespace divine::ui
@@ -300,9 +342,15 @@ namespace divine::ui
         int _max_time = 0;  // seconds
         int _threads = 0;
         int _poolstat_period = 0;
-        brq::cmd_flag _liveness;
+        int64_t _state_table_size = 0;
+        arg::backing _pool_backing;
+        brq::cmd_flag _liveness, _tree_compression, _cold_compression, _profile, _partial,
+                      _record_edges, _shortest, _state_table_hashes;
         bool _interactive = true;
         std::string _solver = "stp";
+        std::string _metrics, _heuristic, _ltl;
+        arg::metrics _metrics_format = arg::metrics::jsonl;
+        arg::fairness _fairness = arg::fairness::none;
 
         void setup() override;
         void run() override;
@@ -335,8 +383,42 @@ namespace divine::ui
             c.opt( "--threads", _threads ) << "number of worker threads to use";
             c.opt( "--max-memory", _max_mem ) << "set a memory limit";
             c.opt( "--max-time", _max_time ) << "set a time limit (in seconds)";
+            c.opt( "--partial", _partial )
+                << "when close to --max-memory, stop storing new states and report a partial "
+                   "result instead of running out of memory";
             c.opt( "--liveness", _liveness ) << "enable verification of liveness properties";
+            c.opt( "--ltl", _ltl )
+                << "check that the program satisfies an LTL formula (implies --liveness); its "
+                   "atomic propositions are global variables, true when nonzero";
+            c.opt( "--fairness", _fairness )
+                << "fairness of --liveness counterexamples: 'weak' or 'strong' is enforced by "
+                   "the model checker, 'dios' by the 'fair' DiOS configuration [dios, or weak "
+                   "with --ltl]";
+            c.opt( "--shortest", _shortest )
+                << "explore the states level by level, so that counterexamples are shortest";
+            c.opt( "--heuristic", _heuristic )
+                << "best-first search towards errors: 'fault' (distance to a fault in the code), "
+                   "'trace' (__vm_trace 'priority: N' scores) or both, comma-separated";
             c.opt( "--solver", _solver ) << "select a constraint solver to use in --symbolic mode";
+            c.opt( "--tree-compression", _tree_compression )
+                << "store visited states as hash-consed trees to save memory";
+            c.opt( "--cold-compression", _cold_compression )
+                << "compress objects of fully explored states (implies --tree-compression)";
+            c.opt( "--record-edges", _record_edges )
+                << "remember how each state was reached (faster counterexamples, more memory)";
+            c.opt( "--state-table-size", _state_table_size )
+                << "expected number of states (pre-sizes the table of visited states)";
+            c.opt( "--state-table-hashes", _state_table_hashes )
+                << "remember the hash of each visited state (faster table growth, more memory)";
+            c.opt( "--metrics", _metrics )
+                << "stream progress and memory metrics into a file";
+            c.opt( "--metrics-format", _metrics_format )
+                << "format of the metrics file: jsonl or prometheus [jsonl]";
+            c.opt( "--profile", _profile )
+                << "report where each thread spends its time (hashing, evaluation, ...)";
+            c.opt( "--pool-backing", _pool_backing )
+                << "memory for state storage: mmap, thp or hugetlb, add ',release' "
+                   "to return freed pages to the system [mmap]";
 
         }
     };
@@ -362,6 +444,7 @@ namespace divine::ui
     {
         brq::cmd_flag _trace, _virtual, _exhaustive;
         std::string _tactic = "none";
+        int _threads = 1;
 
         void setup();
         void run();
@@ -374,6 +457,7 @@ namespace divine::ui
             c.opt( "--trace", _trace ) << "print instructions as they are executed";
             c.opt( "--tactic", _tactic ) << "choose search objective (coverage, fault) [none]";
             c.opt( "--exhaustive", _exhaustive );
+            c.opt( "--threads", _threads ) << "number of worker threads for --exhaustive [1]";
         }
     };
 
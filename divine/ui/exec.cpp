@@ -62,10 +62,10 @@ namespace divine::ui
         if ( _trace )
             exec.trace();
         else
-            exec.run( _exhaustive, _tactic ); // TODO: What about trace?
+            exec.run( _exhaustive, _tactic, _threads ); // TODO: What about trace?
 
         _log->progress( { 0, 0 }, 0, true );
-        _log->memory( exec.poolstats(), mc::HashStats(), true ); // TODO: What about HashStats?
+        _log->memory( exec.poolstats(), mc::HashStats(), mc::ProfileStats(), true ); // TODO: What about HashStats?
 
         report_options();
 
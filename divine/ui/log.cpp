@@ -23,6 +23,8 @@
 #include <divine/mc/trace.hpp>
 #include <divine/mc/types.hpp>
 #include <divine/smt/solver.hpp>
+#include <divine/mem/cow.hpp>
+#include <divine/ss/search.hpp>
 
 using namespace std::literals;
 
@@ -55,11 +57,31 @@ void printpool( std::ostream &ostr, std::string name, const brick::mem::Stats &s
 {
     ostr << name << ":" << std::endl;
     ostr << "  total: " << printitem( s.total ) << std::endl;
+    if ( s.nodes.size() > 1 )
+        for ( auto &[ id, n ] : s.nodes )
+            ostr << "  node " << id << ": " << printitem( n ) << std::endl;
     for ( auto i : s )
         if ( i.count.held )
             ostr << "  " << i.size << ": " << printitem( i ) << std::endl;
 }
 
+void printhash( std::ostream &ostr, std::string name, const brq::hash_set_stats &s )
+{
+    ostr << name << ": { used: " << s.used << ", capacity: " << s.capacity;
+    if ( !s.inserts && !s.lookups )
+        return void( ostr << " }" << std::endl );
+
+    ostr << ", inserts: " << s.inserts << ", lookups: " << s.lookups
+         << ", growths: " << s.growths << ", tombstones: " << s.tombstones << std::endl
+         << "    hash-matches: " << s.hash_matches << ", false-matches: " << s.false_matches;
+    if ( s.fast_compares || s.slow_compares )
+        ostr << ", fast-compares: " << s.fast_compares << ", slow-compares: " << s.slow_compares;
+    ostr << std::endl << "    probes: [";
+    for ( size_t i = 0; i < s.probes.size(); ++i )
+        ostr << ( i ? ", " : " " ) << s.probes[ i ];
+    ostr << " ] }" << std::endl;
+}
+
 template< typename timer >
 void print_timer( std::ostream &ostr, std::string name )
 {
@@ -78,6 +100,43 @@ void print_timers( std::ostream &ostr, std::string name )
     print_timer< mc::hash_timer >( ostr, "hash" );
 }
 
+template< typename timer >
+void read_profile( mc::ProfileStats &p, std::string name )
+{
+    for ( int i = 0; i < 32; ++i )
+        if ( auto [ c, h ] = timer::read( i ); h )
+            p.threads[ i ][ name ] = { c, h };
+}
+
+mc::ProfileStats read_profile()
+{
+    mc::ProfileStats p;
+    p.wall = brq::profile_wall();
+    read_profile< mc::divm_timer >( p, "divm" );
+    read_profile< mc::hash_timer >( p, "hash" );
+    read_profile< mc::grow_timer >( p, "hash-grow" );
+    read_profile< mc::reexec_timer >( p, "reexec" );
+    read_profile< mem::snapshot_timer >( p, "snapshot" );
+    read_profile< mem::dedup_timer >( p, "dedup" );
+    read_profile< smt::feasibility_timer >( p, "smt-f" );
+    read_profile< smt::equality_timer >( p, "smt-eq" );
+    read_profile< ss::wait_timer >( p, "queue-wait" );
+    return p;
+}
+
+void printprofile( std::ostream &ostr, const mc::ProfileStats &p )
+{
+    ostr << "profile:" << std::endl
+         << "  wall mcycles: " << p.wall / 1000000 << std::endl;
+    for ( auto &[ id, timers ] : p.threads )
+    {
+        ostr << "  thread " << id << ":" << std::endl;
+        for ( auto &[ name, t ] : timers )
+            ostr << "    " << name << ": { mcycles: " << t.cycles / 1000000 << ", hits: " << t.hits
+                 << ", share: " << ( p.wall ? double( t.cycles ) / p.wall : 0.0 ) << " }" << std::endl;
+    }
+}
+
 template< typename stream, typename T >
 void fmt_list( stream &s, const std::deque< T > &q )
 {
@@ -124,16 +183,18 @@ struct YamlSink : TimedSink
         print_timers( _out, "search" );
     }
 
-    void memory( const mc::PoolStats &ps, const mc::HashStats &hs, bool last ) override
+    void memory( const mc::PoolStats &ps, const mc::HashStats &hs,
+                 const mc::ProfileStats &pr, bool last ) override
     {
+        if ( last && !pr.empty() )
+            _out << std::endl << std::setprecision( 3 ), printprofile( _out, pr );
         if ( !last || !_detailed )
             return;
         _out << std::endl;
         for ( auto [ name, stat ] : ps )
             printpool( _out, name, stat );
         for ( auto [ name, stat ] : hs )
-            _out << name << ": { used: " << stat.used
-                         << ", capacity: " << stat.capacity << " }" << std::endl;
+            printhash( _out, name, stat );
     }
 
     void result( mc::Result result, const mc::Trace &trace ) override
@@ -154,7 +215,8 @@ struct YamlSink : TimedSink
         }
 
         _out << result << std::endl;
-        if ( result == mc::Result::None || result == mc::Result::Valid )
+        if ( result == mc::Result::None || result == mc::Result::Valid ||
+             result == mc::Result::Partial )
             return;
         _out << "error trace: |" << std::endl;
         for ( auto l : trace.labels )
@@ -233,6 +295,11 @@ struct InteractiveSink : TimedSink
                       << " " << ips_unit << ", queued: " << queued << endline();
     }
 
+    void status( std::string st ) override
+    {
+        std::cerr << clear() << st << ( _rewrite ? endline() : "" ) << std::endl;
+    }
+
     void loader( Phase p ) override
     {
         switch ( p )
@@ -34,9 +34,11 @@ using DbgContext = dbg::Context< vm::CowHeap >;
 struct LogSink
 {
     virtual void progress( std::pair< int64_t, int64_t >, int, bool ) {}
-    virtual void memory( const mc::PoolStats &, const mc::HashStats &, bool ) {}
+    virtual void memory( const mc::PoolStats &, const mc::HashStats &,
+                         const mc::ProfileStats &, bool ) {}
     virtual void loader( Phase ) {}
     virtual void info( std::string, bool = false ) {}
+    virtual void status( std::string ) {} /* transient notes, not part of the report */
     virtual void result( mc::Result, const mc::Trace & ) {}
     virtual void backtrace( DbgContext &, int ) {}
     virtual void start() {}
@@ -50,6 +52,9 @@ SinkPtr nullsink(); /* a global null sink */
 SinkPtr make_interactive();
 SinkPtr make_yaml( std::ostream &output, bool detailed );
 SinkPtr make_composite( std::vector< SinkPtr > );
+SinkPtr make_metrics( std::string path, bool prometheus ); /* JSON lines otherwise */
+
+mc::ProfileStats read_profile(); /* per-thread readings of all timers */
 
 template< typename Self >
 struct CompositeMixin : LogSink
@@ -59,8 +64,9 @@ struct CompositeMixin : LogSink
     void progress( std::pair< int64_t, int64_t > x, int y, bool l ) override
     { self().each( [&]( auto s ) { s->progress( x, y, l ); } ); }
 
-    void memory( const mc::PoolStats &st, const mc::HashStats &hs, bool l ) override
-    { self().each( [&]( auto s ) { s->memory( st, hs, l ); } ); }
+    void memory( const mc::PoolStats &st, const mc::HashStats &hs,
+                 const mc::ProfileStats &pr, bool l ) override
+    { self().each( [&]( auto s ) { s->memory( st, hs, pr, l ); } ); }
 
     void backtrace( DbgContext &c, int lim ) override
     { self().each( [&]( auto s ) { s->backtrace( c, lim ); } ); }
@@ -68,6 +74,9 @@ struct CompositeMixin : LogSink
     void info( std::string i, bool detail ) override
     { self().each( [&]( auto s ) { s->info( i, detail ); } ); }
 
+    void status( std::string st ) override
+    { self().each( [&]( auto s ) { s->status( st ); } ); }
+
     void loader( Phase p ) override
     { self().each( [&]( auto s ) { s->loader( p ); } ); }
 
@@ -0,0 +1,210 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+
+/*
+ * (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <divine/ui/log.hpp>
+#include <divine/smt/solver.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+
+namespace divine::ui
+{
+
+/*
+ * Machine-readable progress metrics, for consumption by external monitoring.
+ * A sample is taken at each progress update of the search (every 500ms) and
+ * either appended as a single JSON object per line, or written out as a
+ * Prometheus text exposition file. The latter is replaced atomically (written
+ * to a temporary file which is then renamed), so that a scraper never sees a
+ * partial file. Pool and hash table figures come from the most recent memory
+ * update, which is less frequent than progress updates.
+ */
+
+struct MetricsSink : LogSink
+{
+    std::string _path;
+    bool _prometheus;
+    std::ofstream _jsonl;
+
+    Clock::time_point _start, _last;
+    int64_t _states = 0, _instructions = 0, _queued = 0;
+    double _states_rate = 0, _instructions_rate = 0;
+    std::pair< long, long > _solver;
+    mc::PoolStats _pools;
+    mc::HashStats _hashes;
+    bool _done = false;
+
+    MetricsSink( std::string path, bool prometheus )
+        : _path( path ), _prometheus( prometheus ), _start( Clock::now() ), _last( _start )
+    {
+        if ( !_prometheus )
+            _jsonl.open( _path, std::ios::trunc );
+    }
+
+    void start() override { _start = _last = Clock::now(); }
+
+    void progress( std::pair< int64_t, int64_t > stat, int queued, bool last ) override
+    {
+        auto now = Clock::now();
+        double secs = std::chrono::duration< double >( now - _last ).count();
+
+        if ( secs > 0 )
+        {
+            _states_rate = ( stat.first - _states ) / secs;
+            _instructions_rate = ( stat.second - _instructions ) / secs;
+        }
+
+        std::tie( _states, _instructions ) = stat;
+        _queued = queued;
+        _last = now;
+        _solver = solver();
+
+        if ( !last ) /* the final sample is written once the memory stats are in */
+            sample();
+    }
+
+    void memory( const mc::PoolStats &ps, const mc::HashStats &hs,
+                 const mc::ProfileStats &, bool last ) override
+    {
+        _pools = ps;
+        _hashes = hs;
+        if ( last )
+            _done = true, sample();
+    }
+
+    static std::string quote( std::string_view s )
+    {
+        std::string r = "\"";
+        for ( char c : s )
+        {
+            if ( c == '"' || c == '\\' )
+                r += '\\';
+            r += c;
+        }
+        return r + "\"";
+    }
+
+    double elapsed() { return std::chrono::duration< double >( _last - _start ).count(); }
+
+    std::pair< long, long > solver()
+    {
+        auto [ fc, fh ] = smt::feasibility_timer::read();
+        auto [ ec, eh ] = smt::equality_timer::read();
+        return { fc + ec, fh + eh };
+    }
+
+    void sample()
+    {
+        if ( _prometheus )
+            write_prometheus();
+        else
+            write_json();
+    }
+
+    void write_json()
+    {
+        auto [ s_cycles, s_hits ] = _solver;
+        auto time = std::chrono::duration< double >(
+                        std::chrono::system_clock::now().time_since_epoch() ).count();
+
+        _jsonl << std::fixed << std::setprecision( 3 )
+               << "{\"time\": " << time << ", \"elapsed\": " << elapsed()
+               << ", \"states\": " << _states << ", \"states_per_second\": " << _states_rate
+               << ", \"instructions\": " << _instructions
+               << ", \"instructions_per_second\": " << _instructions_rate
+               << ", \"queued\": " << _queued
+               << ", \"solver\": { \"cycles\": " << s_cycles << ", \"queries\": " << s_hits << " }";
+
+        _jsonl << ", \"pools\": {";
+        for ( auto &[ name, st ] : _pools )
+            _jsonl << ( &name == &_pools.begin()->first ? " " : ", " ) << quote( name )
+                   << ": { \"used\": " << st.total.bytes.used
+                   << ", \"held\": " << st.total.bytes.held << " }";
+
+        _jsonl << " }, \"hash_tables\": {";
+        for ( auto &[ name, st ] : _hashes )
+            _jsonl << ( &name == &_hashes.begin()->first ? " " : ", " ) << quote( name )
+                   << ": { \"used\": " << st.used << ", \"capacity\": " << st.capacity << " }";
+
+        _jsonl << " }, \"done\": " << ( _done ? "true" : "false" ) << "}" << std::endl;
+    }
+
+    void write_prometheus()
+    {
+        auto tmp = _path + ".tmp";
+        std::ofstream out( tmp, std::ios::trunc );
+        auto [ s_cycles, s_hits ] = _solver;
+
+        auto metric = [&]( std::string name, std::string type, std::string help )
+        {
+            out << "# HELP divine_" << name << " " << help << std::endl
+                << "# TYPE divine_" << name << " " << type << std::endl;
+        };
+
+        out << std::fixed << std::setprecision( 3 );
+
+        metric( "states_total", "counter", "states visited so far" );
+        out << "divine_states_total " << _states << std::endl;
+        metric( "states_per_second", "gauge", "states visited per second (last interval)" );
+        out << "divine_states_per_second " << _states_rate << std::endl;
+        metric( "instructions_total", "counter", "instructions executed so far" );
+        out << "divine_instructions_total " << _instructions << std::endl;
+        metric( "instructions_per_second", "gauge", "instructions per second (last interval)" );
+        out << "divine_instructions_per_second " << _instructions_rate << std::endl;
+        metric( "queue_size", "gauge", "states waiting to be explored" );
+        out << "divine_queue_size " << _queued << std::endl;
+        metric( "elapsed_seconds", "gauge", "time since the search started" );
+        out << "divine_elapsed_seconds " << elapsed() << std::endl;
+        metric( "solver_cycles_total", "counter", "CPU cycles spent in the SMT solver" );
+        out << "divine_solver_cycles_total " << s_cycles << std::endl;
+        metric( "solver_queries_total", "counter", "SMT solver queries" );
+        out << "divine_solver_queries_total " << s_hits << std::endl;
+
+        metric( "pool_used_bytes", "gauge", "memory in use by each pool" );
+        for ( auto &[ name, st ] : _pools )
+            out << "divine_pool_used_bytes{pool=" << quote( name ) << "} "
+                << st.total.bytes.used << std::endl;
+        metric( "pool_held_bytes", "gauge", "memory held by each pool" );
+        for ( auto &[ name, st ] : _pools )
+            out << "divine_pool_held_bytes{pool=" << quote( name ) << "} "
+                << st.total.bytes.held << std::endl;
+
+        metric( "hash_used_cells", "gauge", "occupied cells of each hash table" );
+        for ( auto &[ name, st ] : _hashes )
+            out << "divine_hash_used_cells{table=" << quote( name ) << "} " << st.used << std::endl;
+        metric( "hash_capacity_cells", "gauge", "capacity of each hash table" );
+        for ( auto &[ name, st ] : _hashes )
+            out << "divine_hash_capacity_cells{table=" << quote( name ) << "} "
+                << st.capacity << std::endl;
+
+        metric( "search_done", "gauge", "1 once the search has finished" );
+        out << "divine_search_done " << ( _done ? 1 : 0 ) << std::endl;
+
+        out.close();
+        if ( out && std::rename( tmp.c_str(), _path.c_str() ) )
+            std::remove( tmp.c_str() );
+    }
+};
+
+SinkPtr make_metrics( std::string path, bool prometheus )
+{
+    return std::make_shared< MetricsSink >( path, prometheus );
+}
+
+}
@@ -199,7 +199,8 @@ struct ODBCSink : TimedSink
         }
     }
 
-    void memory( const mc::PoolStats &st, const mc::HashStats &, bool ) override
+    void memory( const mc::PoolStats &st, const mc::HashStats &,
+                 const mc::ProfileStats &, bool ) override
     {
         for ( const auto &pool : st )
         {
@@ -224,6 +225,7 @@ struct ODBCSink : TimedSink
         switch ( r )
         {
             case Result::None:      rchar = "U"; break;
+            case Result::Partial:   rchar = "U"; break;
             case Result::Error:     rchar = "E"; break;
             case Result::BootError: rchar = "B"; break;
             case Result::Valid:     rchar = "V"; break;
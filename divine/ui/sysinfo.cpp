@@ -261,6 +261,12 @@ void SysInfo::report( std::function< void ( std::string, std::string ) > yield )
     yield( "wall time", std::to_string( wallTime() ) );
 }
 
+/* vmSize is what counts towards the limit set below */
+bool SysInfo::nearMemoryLimit( uint64_t memory, double fraction ) const
+{
+    return memory && vmSize() * 1024 > memory * fraction;
+}
+
 void SysInfo::setMemoryLimitInBytes( uint64_t memory ) {
     if ( !memory )
         return;
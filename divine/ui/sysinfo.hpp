@@ -41,6 +41,7 @@ struct SysInfo {
     void updateAndCheckTimeLimit( uint64_t time );
 
     void setMemoryLimitInBytes( uint64_t memory );
+    bool nearMemoryLimit( uint64_t memory, double fraction = 0.85 ) const;
 
     std::string architecture() const;
     uint64_t memory() const;
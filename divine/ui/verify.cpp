@@ -25,6 +25,9 @@
 #include <divine/ui/cli.hpp>
 #include <divine/ui/sysinfo.hpp>
 
+#include <sstream>
+#include <iomanip>
+
 namespace divine {
 namespace ui {
 
@@ -47,16 +50,55 @@ void verify::setup()
             log.push_back( make_yaml( *_report_file.get(), true ) );
         }
 
+        if ( !_metrics.empty() )
+        {
+            /* first, so that it sees the timers before the report resets them */
+            log.insert( log.begin(),
+                        make_metrics( _metrics, _metrics_format == arg::metrics::prometheus ) );
+            if ( !_poolstat_period )
+                _poolstat_period = 10; /* memory stats every 10 seconds */
+        }
+
         _log = make_composite( log );
     }
 
-    if ( _bc_opts.dios_config.empty() && _liveness )
+    if ( !_ltl.empty() )
+        _liveness = true;
+
+    /* the 'fair' configuration relies on the program marking accepting edges,
+     * but in the product with an --ltl property, only the automaton does */
+    if ( _fairness == arg::fairness::none )
+        _fairness = _ltl.empty() ? arg::fairness::dios : arg::fairness::weak;
+    if ( !_ltl.empty() && _fairness == arg::fairness::dios )
+        die( "--fairness dios does not work with --ltl, use weak or strong" );
+
+    if ( _shortest && !_heuristic.empty() )
+        die( "--shortest and --heuristic select different search orders, use only one of them" );
+    if ( _shortest && _liveness )
+        die( "--shortest only applies to safety checking, not to --liveness or --ltl" );
+    if ( !_heuristic.empty() && _liveness )
+        die( "--heuristic only applies to safety checking, not to --liveness or --ltl" );
+    if ( _partial && _liveness ) /* a dropped state could hide an accepting cycle */
+        die( "--partial only applies to safety checking, not to --liveness or --ltl" );
+
+    if ( _bc_opts.dios_config.empty() && _liveness && _fairness == arg::fairness::dios )
         _bc_opts.dios_config = "fair";
 
+    brick::mem::backing() = _pool_backing; /* before any pools are created */
     with_bc::setup();
 
     if ( _bc_opts.symbolic )
         bitcode()->solver( _solver );
+    if ( _tree_compression || _cold_compression )
+        bitcode()->tree_compression( true );
+    if ( _cold_compression )
+        bitcode()->cold_compression( true );
+    if ( _record_edges )
+        bitcode()->record_edges( true );
+    if ( _state_table_size > 0 )
+        bitcode()->state_table_size( _state_table_size );
+    if ( _state_table_hashes )
+        bitcode()->state_table_hashes( true );
 }
 
 void check::setup()
@@ -133,28 +175,80 @@ void verify::safety()
         _threads = std::min( 4u, std::thread::hardware_concurrency() );
 
     auto safety = mc::make_job< mc::Safety >( bitcode(), ss::passive_listen() );
+    if ( _shortest )
+        safety->order( ss::Order::BFS );
+    if ( !_heuristic.empty() )
+        safety->heuristic( mc::Heuristic( _heuristic, *bitcode() ) );
 
     SysInfo sysinfo;
     sysinfo.setMemoryLimitInBytes( _max_mem.size );
 
     _log->start();
     int ps_ctr = 0;
+    std::pair< int64_t, double > saturated( 0, 0 ); /* states, seconds */
+
+    if ( _profile )
+        brq::start_profiling();
 
     safety->start( _threads, [&]( bool last )
                    {
+                       /* timers are only consistent once the workers stop, and
+                        * progress() resets the aggregate ones */
+                       auto profile = last && _profile ? read_profile() : mc::ProfileStats();
                        _log->progress( safety->stats(),
                                        safety->queuesize(), last );
                        if ( last || ( ++ps_ctr == 2 * _poolstat_period ) )
-                           ps_ctr = 0, _log->memory( safety->poolstats(), safety->hashstats(), last );
+                           ps_ctr = 0, _log->memory( safety->poolstats(), safety->hashstats(),
+                                                     profile, last );
                        if ( !last )
                            sysinfo.updateAndCheckTimeLimit( _max_time );
+                       if ( !last && _partial && !saturated.first &&
+                            sysinfo.nearMemoryLimit( _max_mem.size ) )
+                       {
+                           safety->saturate();
+                           saturated = std::make_pair( safety->stats().first, sysinfo.wallTime() );
+                           _log->status( "memory limit close, no new states will be stored" );
+                       }
                    } );
     safety->wait();
     report_options();
     _log->info( "smt solver: " + _solver + "\n", true );
+    if ( _tree_compression || _cold_compression )
+        _log->info( "tree compression: 1\n", true );
+    if ( _cold_compression )
+        _log->info( "cold compression: 1\n", true );
+    if ( _record_edges )
+        _log->info( "record edges: 1\n", true );
+    if ( _shortest )
+        _log->info( "search order: bfs\n", true );
+    if ( !_heuristic.empty() )
+        _log->info( "heuristic: " + _heuristic + "\n", true );
+    if ( _state_table_size > 0 )
+        _log->info( "state table size: " + std::to_string( _state_table_size ) + "\n", true );
+    if ( _state_table_hashes )
+        _log->info( "state table hashes: 1\n", true );
+    if ( _pool_backing.mode != brick::mem::Backing::Plain || _pool_backing.release )
+    {
+        const char *mode[] = { "mmap", "thp", "hugetlb" };
+        _log->info( std::string( "pool backing: " ) + mode[ _pool_backing.mode ] +
+                    ( _pool_backing.release ? ",release" : "" ) + "\n", true );
+    }
     _log->info( "property type: safety\n", true );
 
-    if ( safety->result() == mc::Result::Valid )
+    if ( safety->dropped() ) /* the result is partial */
+    {
+        /* an unseen state is counted each time it is reached, so this says
+         * little about the number of states that were missed */
+        std::stringstream s;
+        s << std::fixed << std::setprecision( 1 )
+          << "exhaustive: no" << std::endl
+          << "saturated at: { states: " << saturated.first
+          << ", seconds: " << saturated.second << " }" << std::endl
+          << "edges dropped: " << safety->dropped() << std::endl;
+        _log->info( s.str() );
+    }
+
+    if ( safety->result() == mc::Result::Valid || safety->result() == mc::Result::Partial )
         return _log->result( safety->result(), mc::Trace() );
 
     print_ce( *safety );
@@ -164,17 +258,35 @@ void verify::liveness()
 {
     auto liveness = mc::make_job< mc::Liveness >( bitcode(), ss::passive_listen() );
 
+    if ( _fairness == arg::fairness::weak )
+        liveness->fairness( mc::Fairness::Weak );
+    if ( _fairness == arg::fairness::strong )
+        liveness->fairness( mc::Fairness::Strong );
+    if ( !_ltl.empty() )
+        liveness->property( std::make_shared< mc::Property >( _ltl, *bitcode() ) );
+
     _log->start();
+    int ps_ctr = 0;
+
+    if ( _profile )
+        brq::start_profiling();
+
     liveness->start( 1, [&]( bool last )
                    {
+                       auto profile = last && _profile ? read_profile() : mc::ProfileStats();
                        _log->progress( liveness->stats(),
                                        liveness->queuesize(), last );
+                       if ( last || ( ++ps_ctr == 2 * _poolstat_period ) )
+                           ps_ctr = 0, _log->memory( liveness->poolstats(), liveness->hashstats(),
+                                                     profile, last );
                    } );
 
     liveness->wait();
 
     report_options();
     _log->info( "property type: liveness\n", true );
+    if ( !_ltl.empty() )
+        _log->info( "property: \"" + _ltl + "\"\n", true );
 
     print_ce( *liveness );
 }
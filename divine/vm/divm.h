@@ -449,6 +449,15 @@ void  __vm_obj_free( void *ptr ) NOTHROW;
 int   __vm_obj_size( const void * ) NOTHROW;
 void *__vm_obj_clone( const void *root, const void **block ) NOTHROW;
 
+/* Copy or fill a range of memory in a single step. The effect (including the
+ * propagation of definedness, pointer and taint metadata) is the same as that
+ * of the equivalent sequence of byte-sized loads and stores, except that no
+ * intermediate state is observable. __vm_memmove allows the ranges to overlap.
+ * Both ranges are bounds-checked up front and nothing is written if either of
+ * them is invalid. */
+void __vm_memmove( void *dst, const void *src, int n ) NOTHROW;
+void __vm_memset( void *dst, int c, int n ) NOTHROW;
+
 /* Read and write additional metadata, indexed by an address and a key. The
  * metadata is only valid as long as the corresponding address is. There are a
  * few reserved keys that allow access to metadata automatically tracked by the
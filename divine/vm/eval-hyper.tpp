@@ -173,6 +173,72 @@ namespace divine::vm
             result( PointerV( mem::clone( heap(), heap(), ptr, visited, mem::CloneType::All ) ) );
     }
 
+    /* An overlapping copy within a single object is done in chunks no larger
+     * than the distance of the two ranges, starting from the end that would
+     * otherwise be overwritten before it is read. */
+
+    template< typename Ctx >
+    void Eval< Ctx >::implement_hypercall_memmove()
+    {
+        auto to = operand< PointerV >( 0 ), from = operand< PointerV >( 1 );
+        int len = operandCk< IntV >( 2 ).cooked();
+
+        if ( len < 0 )
+        {
+            fault( _VM_F_Hypercall ) << "negative size " << len << " passed to __vm_memmove";
+            return;
+        }
+
+        if ( !len || !boundcheck( from, len, false ) || !boundcheck( to, len, true ) )
+            return;
+
+        auto src = ptr2h( from ), dst = ptr2h( to );
+        int dist = src.object() == dst.object() ? dst.offset() - src.offset() : len;
+        int chunk = std::min( len, std::abs( dist ) );
+
+        for ( int done = 0; chunk && done < len; done += chunk )
+        {
+            int sz = std::min( chunk, len - done ), off = dist > 0 ? len - done - sz : done;
+            auto s = src, d = dst;
+            s.offset( src.offset() + off );
+            d.offset( dst.offset() + off );
+            heap().copy( s, d, sz );
+        }
+
+        context().flush_ptr2i(); /* the target may have been detached */
+    }
+
+    /* Store the first byte, then keep doubling the initialised prefix. */
+
+    template< typename Ctx >
+    void Eval< Ctx >::implement_hypercall_memset()
+    {
+        auto to = operand< PointerV >( 0 );
+        auto byte = value::Int< 8, true >( operand< IntV >( 1 ) );
+        int len = operandCk< IntV >( 2 ).cooked();
+
+        if ( len < 0 )
+        {
+            fault( _VM_F_Hypercall ) << "negative size " << len << " passed to __vm_memset";
+            return;
+        }
+
+        if ( !len || !boundcheck( to, len, true ) )
+            return;
+
+        auto dst = ptr2h( to );
+        heap().write( dst, byte );
+
+        for ( int done = 1; done < len; done *= 2 )
+        {
+            auto d = dst;
+            d.offset( dst.offset() + done );
+            heap().copy( dst, d, std::min( done, len - done ) );
+        }
+
+        context().flush_ptr2i();
+    }
+
     template< typename Ctx >
     void Eval< Ctx >::implement_ctl_set_frame()
     {
@@ -680,6 +746,10 @@ namespace divine::vm
             }
             case lx::HypercallObjClone:
                 return implement_hypercall_clone();
+            case lx::HypercallMemMove:
+                return implement_hypercall_memmove();
+            case lx::HypercallMemSet:
+                return implement_hypercall_memset();
             default:
                 UNREACHABLE( "unknown hypercall", instruction().subcode );
         }
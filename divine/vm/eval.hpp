@@ -425,6 +425,8 @@ public:
 
     void implement_hypercall_syscall();
     void implement_hypercall_clone();
+    void implement_hypercall_memmove();
+    void implement_hypercall_memset();
     void implement_hypercall();
 
     void implement_call( bool invoke );
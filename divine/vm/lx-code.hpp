@@ -57,7 +57,11 @@ enum Hypercall /* see divm.h for prototypes & documentation */
     HypercallObjFree,
     HypercallObjShared,
     HypercallObjResize,
-    HypercallObjSize
+    HypercallObjSize,
+
+    /* bulk memory operations */
+    HypercallMemMove,
+    HypercallMemSet
 };
 
 enum DbgSubcode
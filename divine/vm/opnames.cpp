@@ -130,6 +130,9 @@ namespace divine::vm
                 case lx::HypercallObjSize: op += ".obj.size"; break;
                 case lx::HypercallObjClone: op += ".obj.clone"; break;
 
+                case lx::HypercallMemMove: op += ".memmove"; break;
+                case lx::HypercallMemSet: op += ".memset"; break;
+
                 default: UNREACHABLE( "unexpected hypercall opcode" ); break;
             }
         return op;
@@ -119,6 +119,30 @@ struct Eval
         ASSERT_EQ( x, 10 );
     }
 
+    TEST(memmove)
+    {
+        auto f = [this]( int from, int to ) {
+            return testF( "void __vm_memmove( void *, const void *, int ); "
+                          "int array[8] = { 0, 1, 2, 3, 4, 5, 6, 7 }; "
+                          "int f() { __vm_memmove( array + " + std::to_string( to ) +
+                          ", array + " + std::to_string( from ) + ", 5 * sizeof( int ) ); "
+                          "int r = 0; for ( int i = 0; i < 8; ++i ) r = 10 * r + array[ i ]; "
+                          "return r; }" );
+        };
+        ASSERT_EQ( f( 0, 3 ), 1201234 );
+        ASSERT_EQ( f( 3, 0 ), 34567567 );
+        ASSERT_EQ( f( 0, 1 ), 123467 );
+        ASSERT_EQ( f( 2, 2 ), 1234567 );
+    }
+
+    TEST(memset)
+    {
+        int x = testF( "void __vm_memset( void *, int, int ); char array[100]; "
+                       "int f() { __vm_memset( array + 1, 7, 97 ); "
+                       "return array[ 0 ] + array[ 1 ] + array[ 50 ] + array[ 97 ] + array[ 98 ]; }" );
+        ASSERT_EQ( x, 21 );
+    }
+
     TEST(array_1g)
     {
         auto f = [this]( int i ) {
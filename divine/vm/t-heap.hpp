@@ -412,6 +412,113 @@ namespace divine::t_vm
             ASSERT_EQ( iv.cooked(), 7 );
         }
 
+        TEST(tree_restore)
+        {
+            heap.tree_compression( pool );
+            auto p = heap.make( 16 ).cooked(), q = heap.make( 16 ).cooked();
+            for ( int i = 0; i < 5; ++i )
+                heap.write( heap.make( 16 ).cooked(), IntV( i ) );
+
+            heap.write( p, PointerV( q ) );
+            auto s1 = heap.snapshot( pool );
+            heap.write( p, IntV( 7 ) );
+            auto s2 = heap.snapshot( pool );
+            heap.write( p, PointerV( q ) );
+            auto s3 = heap.snapshot( pool );
+
+            ASSERT( heap.snap_equal( pool, s1, s3 ) );
+            ASSERT( !heap.snap_equal( pool, s1, s2 ) );
+
+            IntV iv; PointerV pv;
+
+            heap.restore( pool, s2 );
+            heap.read( p, iv );
+            ASSERT_EQ( iv.cooked(), 7 );
+            heap.restore( pool, s1 );
+            heap.read( p, pv );
+            ASSERT_EQ( pv.cooked(), q );
+        }
+
+        TEST(cold_restore)
+        {
+            heap.tree_compression( pool );
+            heap.cold_compression( pool );
+            auto p = heap.make( 256 ).cooked(), q = heap.make( 16 ).cooked();
+            for ( int i = 0; i < 64; ++i )
+                heap.write( p + 4 * i, IntV( i % 4 ) );
+
+            heap.write( q, PointerV( p ) );
+            auto s1 = heap.snapshot( pool );
+
+            heap.cold_enter();
+            heap.freeze( pool, s1 );
+            heap.cold_leave();
+            ASSERT_LT( 0, heap.cold_stats().total.count.used );
+            ASSERT_LT( heap.cold_stats().total.bytes.used, heap.cold_stats().total.bytes.held );
+
+            heap.write( p + 8, IntV( 7 ) );
+            auto s2 = heap.snapshot( pool );
+
+            IntV iv; PointerV pv;
+
+            heap.restore( pool, s1 );
+            heap.read( p + 8, iv );
+            ASSERT_EQ( iv.cooked(), 2 );
+            ASSERT( iv.defined() );
+            heap.read( q, pv );
+            ASSERT_EQ( pv.cooked(), p );
+
+            heap.restore( pool, s2 );
+            heap.read( p + 8, iv );
+            ASSERT_EQ( iv.cooked(), 7 );
+            heap.read( p + 12, iv );
+            ASSERT_EQ( iv.cooked(), 3 );
+        }
+
+        TEST(cold_slots) /* copies of the heap give their slot back */
+        {
+            heap.tree_compression( pool );
+            heap.cold_compression( pool );
+
+            for ( int i = 0; i < 1000; ++i )
+            {
+                auto copy = heap;
+                copy.cold_enter();
+                copy.cold_leave();
+            }
+        }
+
+        TEST(uniform)
+        {
+            auto p = heap.make( 64 ).cooked(), q = heap.make( 64 ).cooked();
+            auto tag = [&]( auto x ) { return heap.n.uniform( heap.ptr2i( x ) ); };
+            ASSERT_EQ( tag( p ), heap.n.Undefined );
+
+            for ( int i = 0; i < 64; i += 4 )
+                heap.write( p + i, IntV( i ) );
+            ASSERT_EQ( tag( p ), heap.n.Stored );
+            auto h = mem::hash( heap, p );
+
+            heap.snapshot( pool );
+            ASSERT_EQ( tag( p ), heap.n.Defined );
+            ASSERT_EQ( mem::hash( heap, p ), h );
+
+            IntV iv; PointerV pv;
+            heap.copy( p, q, 64 );
+            ASSERT_EQ( tag( q ), heap.n.Defined );
+            heap.read( q + 8, iv );
+            ASSERT_EQ( iv.cooked(), 8 );
+            ASSERT( iv.defined() );
+
+            heap.write( q + 8, PointerV( p ) );
+            ASSERT_EQ( tag( q ), heap.n.Stored );
+            heap.read( q + 8, pv );
+            ASSERT_EQ( pv.cooked(), p );
+            heap.read( q + 16, iv );
+            ASSERT_EQ( iv.cooked(), 16 );
+            ASSERT( iv.defined() );
+        }
+
         TEST(snap_restore_isolation)
         {
             auto p = heap.make( 16 ).cooked(), q = heap.make( 16 ).cooked();
@@ -447,6 +554,37 @@ namespace divine::t_vm
             heap.read( p, iv );
             ASSERT_EQ( iv.defbits(), 0 );
         }
+
+        TEST(fork_restore)
+        {
+            auto p = heap.make( 16 ).cooked(), q = heap.make( 16 ).cooked();
+            heap.write( p, IntV( 5 ) );
+            heap.snapshot( pool );
+            heap.write( q, PointerV( p ) );
+            heap.write( p, IntV( 6 ) );
+            auto f = heap.fork();
+
+            IntV iv; PointerV pv;
+
+            heap.write( p, IntV( 7 ) );
+            heap.restore( f, false );
+            heap.read( p, iv );
+            ASSERT_EQ( iv.cooked(), 6 );
+            heap.write( p, IntV( 8 ) );
+
+            heap.restore( f, true );
+            heap.read( p, iv );
+            ASSERT_EQ( iv.cooked(), 6 );
+            heap.read( q, pv );
+            ASSERT_EQ( pv.cooked(), p );
+            ASSERT( f.dirty.empty() );
+
+            auto s = heap.snapshot( pool );
+            heap.write( p, IntV( 9 ) );
+            heap.restore( pool, s );
+            heap.read( p, iv );
+            ASSERT_EQ( iv.cooked(), 6 );
+        }
     };
 
 }
@@ -280,6 +280,11 @@ lx::Hypercall hypercall( llvm::Function *f )
     if ( name == "__vm_obj_size" )
         return lx::HypercallObjSize;
 
+    if ( name == "__vm_memmove" )
+        return lx::HypercallMemMove;
+    if ( name == "__vm_memset" )
+        return lx::HypercallMemSet;
+
     if ( f->getIntrinsicID() != llvm::Intrinsic::not_intrinsic )
         return lx::NotHypercallButIntrinsic;
 
@@ -162,9 +162,36 @@ struct MemInterrupt
 
                 ++_mem;
             }
+
+            if ( auto call = llvm::dyn_cast< llvm::CallInst >( inst ) )
+                annotateBulk( call );
         }
     }
 
+    /* __vm_memmove reads its second argument and writes the first one, while
+     * __vm_memset only writes; the size is always the last argument */
+    void annotateBulk( llvm::CallInst *call )
+    {
+        auto fn = call->getCalledFunction();
+        if ( !fn || ( fn->getName() != "__vm_memmove" && fn->getName() != "__vm_memset" ) )
+            return;
+
+        auto *type = _hypercall->getFunctionType();
+        llvm::IRBuilder<> irb{ &*std::next( llvm::BasicBlock::iterator( call ) ) };
+        auto *size = irb.CreateZExtOrTrunc( call->getArgOperand( 2 ), type->getParamType( 1 ) );
+
+        auto crit = [&]( llvm::Value *ptr, int intr_type )
+        {
+            ptr = irb.CreateBitCast( ptr, type->getParamType( 0 ) );
+            irb.CreateCall( _hypercall, { ptr, size, irb.getInt32( intr_type ), _handler } );
+            ++_mem;
+        };
+
+        if ( fn->getName() == "__vm_memmove" )
+            crit( call->getArgOperand( 1 ), _VM_MAT_Load );
+        crit( call->getArgOperand( 0 ), _VM_MAT_Store );
+    }
+
     void run( llvm::Module &m )
     {
         if ( !tagModuleWithMetadata( m, "lart.divine.interrupt.mem" ) )
@@ -265,6 +265,12 @@ struct Substitute {
             *p.second = cloneFunctionRecursively( p.first, cloneMap, not_vm, const_null );
         }
 
+        /* The bulk memory hypercalls bypass store buffers: only the clones
+         * above (which are not transformed) may keep using them. */
+        auto bulk = m.getFunction( "_PDCLIB_bulkmem" );
+        if ( bulk )
+            makeReturnConstant( bulk, 0 );
+
         /* Make sure divine.debugfn (DbgCall) functions do not use weakmem --
          * these functions run only in debug mode (trace, sim, draw), and must
          * not call __vm_choose. To ensure they see consistent memory, we
@@ -306,6 +312,8 @@ struct Substitute {
             makeReturnConstant( fsize, _bufferSize );
         }
         inlineIntoCallers( fsize );
+        if ( bulk )
+            inlineIntoCallers( bulk );
         mk_init( lart_init, weakmem_init, state );
     }
 
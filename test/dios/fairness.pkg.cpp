@@ -8,6 +8,8 @@
 
 // V: unfair V_OPT: --dios-config default
 // V: fair   V_OPT: --dios-config fair
+// V: weak   V_OPT: --dios-config default --fairness weak
+// V: strong V_OPT: --dios-config default --fairness strong
 
 bool checkX();
 void __buchi_accept();
@@ -0,0 +1,49 @@
+# TAGS:
+. lib/testcase
+
+# record a trace in passthrough mode, convert it to the indexed format and
+# check that both replay the same way
+
+cat > prog.c <<EOF
+#include <assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+int main()
+{
+    char buf[ 8 ] = { 0 };
+    int fd = open( "data.txt", O_CREAT | O_TRUNC | O_WRONLY, 0644 );
+    assert( fd >= 0 );
+    assert( write( fd, "hello", 5 ) == 5 );
+    close( fd );
+
+    fd = open( "data.txt", O_RDONLY );
+    assert( fd >= 0 );
+    assert( read( fd, buf, sizeof( buf ) ) == 5 );
+    close( fd );
+    assert( !strcmp( buf, "hello" ) );
+}
+EOF
+
+divine exec prog.c
+test -s passthrough.out
+test "$(cat data.txt)" = hello
+rm data.txt # the replay must not touch the host
+
+mv passthrough.out stream.out
+replay-index stream.out indexed.out
+not cmp stream.out indexed.out
+
+replay-index indexed.out again.out # already indexed, kept as is
+cmp indexed.out again.out
+
+for t in stream indexed; do
+    cp $t.out passthrough.out
+    divine verify --dios-config replay prog.c > $t.report
+    grep "error found: no" $t.report
+    grep "state count:" $t.report > $t.states
+done
+
+diff stream.states indexed.states
+test ! -e data.txt
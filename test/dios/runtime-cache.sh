@@ -0,0 +1,63 @@
+# TAGS: min
+. lib/testcase
+
+# the prelinked runtime is cached in $DIVINE_CACHE
+
+export DIVINE_CACHE=$PWD/cache
+
+cat > prog.c <<EOF
+#include <assert.h>
+int main() { int x = 1; assert( x ); }
+EOF
+
+cat > bug.c <<EOF
+#include <assert.h>
+int main() { int x = 0; assert( x ); }
+EOF
+
+# a strong definition of a symbol that the prelinked runtime also provides,
+# which forces the uncached link
+cat > strlen.c <<EOF
+#include <assert.h>
+#include <string.h>
+static int calls = 0;
+size_t strlen( const char *s ) { ++calls; size_t n = 0; while ( s[ n ] ) ++n; return n; }
+int main() { assert( strlen( "abc" ) == 3 ); assert( calls ); }
+EOF
+
+inode() { stat -c %i "$@"; }
+
+# miss: the runtime is linked and stored
+divine check prog.c
+test $(ls cache/runtime-*.bc | wc -l) = 1
+file=$(ls cache/runtime-*.bc)
+cp $file good.bc
+ino=$(inode $file)
+
+# hit: the file is used as is and the result does not change
+divine check prog.c
+divine check bug.c > bug.out 2>&1 || true
+grep "error found: yes" bug.out
+test $(inode $file) = $ino
+cmp $file good.bc
+
+# a damaged file is a miss: it is rebuilt and replaced
+echo garbage > $file
+divine check prog.c
+divine check bug.c > bug.out 2>&1 || true
+grep "error found: yes" bug.out
+test $(inode $file) != $ino
+cmp $file good.bc
+
+head -c 1000 good.bc > $file
+divine check prog.c
+cmp $file good.bc
+
+# the program overrides part of the runtime, the cached copy is not used
+divine check strlen.c
+cmp $file good.bc
+
+# no cache directory at all
+rm -rf cache
+DIVINE_CACHE= divine check prog.c
+test ! -e cache
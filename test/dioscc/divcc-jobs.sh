@@ -0,0 +1,44 @@
+# TAGS: divcc
+. lib/testcase
+
+# the result of a parallel build (-j) must not depend on the scheduling
+
+for i in 1 2 3 4 5; do
+    cat > f$i.c <<EOF
+int f$i( int x ) { return x * $i + $i; }
+EOF
+done
+
+cat > main.c <<EOF
+#include <assert.h>
+int f1( int ), f2( int ), f3( int ), f4( int ), f5( int );
+int main() { assert( f5( f4( f3( f2( f1( 0 ) ) ) ) ) == 325 ); }
+EOF
+
+FILES="main.c f1.c f2.c f3.c f4.c f5.c"
+
+mkdir serial parallel
+(cd serial && divcc -c $(for f in $FILES; do echo ../$f; done))
+(cd parallel && divcc -j2 -c $(for f in $FILES; do echo ../$f; done))
+for f in $FILES; do
+    cmp serial/${f%.c}.o parallel/${f%.c}.o
+done
+
+divcc -o prog-serial $FILES
+divcc -j2 -o prog-parallel $FILES
+divcc -j 3 -o prog-parallel-3 $FILES
+
+objcopy --dump-section .llvmbc=serial.bc prog-serial
+for p in prog-parallel prog-parallel-3; do
+    objcopy --dump-section .llvmbc=$p.bc $p
+    cmp serial.bc $p.bc
+    ./$p
+done
+
+divine check prog-parallel
+
+# a missing or malformed number of jobs is an error
+not divcc main.c -j 2> err.txt
+grep -- "-j requires a number of jobs" err.txt
+not divcc -j two main.c 2> err.txt
+grep -- "-j value not recognized: two" err.txt
@@ -0,0 +1,27 @@
+/* TAGS: min c */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* large copies go through __vm_memmove, which must keep pointers usable */
+
+int main()
+{
+    int x = 7;
+    int *mem[ 64 ];
+    for ( int i = 0; i < 64; ++i )
+        mem[ i ] = i % 2 ? &x : NULL;
+
+    memmove( mem + 3, mem, 32 * sizeof( int * ) );
+    assert( *mem[ 4 ] == 7 );
+    assert( mem[ 33 ] == NULL );
+
+    memmove( mem, mem + 8, 48 * sizeof( int * ) );
+    assert( *mem[ 0 ] == 7 );
+
+    memset( mem, 0, sizeof( mem ) );
+    for ( int i = 0; i < 64; ++i )
+        assert( mem[ i ] == NULL );
+
+    return 0;
+}
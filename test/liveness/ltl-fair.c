@@ -0,0 +1,25 @@
+/* TAGS: c min threads */
+/* VERIFY_OPTS: --ltl F(go) */
+
+/* Only a run where the worker never gets to run violates the property. Such
+ * a run is not weakly fair, which is the default with --ltl. */
+
+#include <dios.h>
+#include <pthread.h>
+#include <stdbool.h>
+
+int go;
+
+void *worker( void *arg )
+{
+    go = 1;
+    return arg;
+}
+
+int main()
+{
+    pthread_t t;
+    pthread_create( &t, NULL, worker, NULL );
+    while ( true )
+        __dios_reschedule();
+}
@@ -0,0 +1,16 @@
+/* TAGS: c min */
+/* VERIFY_OPTS: --ltl G(F(tick)) */
+/* CC_OPTS: -Os */ // avoid duplicated states
+
+#include <dios.h>
+#include <sys/divm.h>
+#include <stdbool.h>
+
+int tick;
+
+int main() {
+    while ( true ) {
+        __dios_reschedule();
+        tick = !tick;
+    }
+}
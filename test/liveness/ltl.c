@@ -0,0 +1,16 @@
+/* TAGS: c min */
+/* VERIFY_OPTS: --ltl G(F(go)) */
+/* CC_OPTS: -Os */ // avoid duplicated states
+
+#include <dios.h>
+#include <sys/divm.h>
+#include <stdbool.h>
+
+int go;
+
+int main() {
+    while ( true ) {
+        __dios_reschedule(); /* ERROR */
+        go = __vm_choose( 2 );
+    }
+}
@@ -0,0 +1,20 @@
+# TAGS: min
+. lib/testcase
+
+# every alternative of a choice is taken once in an exhaustive exec
+
+cat > test.c <<EOF
+#include <dios.h>
+#include <sys/divm.h>
+
+int main()
+{
+    int x = __vm_choose( 3 );
+    __dios_trace_f( "outcome %d", x );
+}
+EOF
+
+divine exec --exhaustive test.c > exec.out
+grep -o 'outcome [0-9]' exec.out | sort > outcomes
+cat outcomes
+printf 'outcome 0\noutcome 1\noutcome 2\n' | diff -u - outcomes
@@ -0,0 +1,24 @@
+# TAGS: min
+. lib/testcase
+
+# each path of an exhaustive parallel exec runs exactly once
+
+cat > test.c <<EOF
+#include <dios.h>
+#include <sys/divm.h>
+
+int main()
+{
+    int a = __vm_choose( 3 ), b = __vm_choose( 3 ), c = __vm_choose( 2 );
+    __dios_trace_f( "path %d %d %d", a, b, c );
+}
+EOF
+
+for t in 1 2 3; do
+    divine exec --exhaustive --threads $t test.c > exec.out
+    grep -o 'path [0-9] [0-9] [0-9]' exec.out | sort > paths.$t
+    test $(wc -l < paths.$t) -eq 18
+    test $(sort -u paths.$t | wc -l) -eq 18
+done
+
+diff -u paths.1 paths.3
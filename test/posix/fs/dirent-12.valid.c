@@ -0,0 +1,54 @@
+/* TAGS: c */
+#include <assert.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* many entries with a long common prefix (the lookup keys tie), listed in
+ * name order */
+
+int main() {
+    char name[ 32 ];
+    struct stat st;
+    assert( mkdir( "spool", 0755 ) == 0 );
+
+    for ( int i = 39; i >= 0; --i )
+    {
+        snprintf( name, sizeof name, "spool/message-%02d", i );
+        int fd = open( name, O_CREAT | O_WRONLY, 0644 );
+        assert( fd >= 0 );
+        assert( close( fd ) == 0 );
+    }
+
+    for ( int i = 0; i < 40; i += 2 )
+    {
+        snprintf( name, sizeof name, "spool/message-%02d", i );
+        assert( stat( name, &st ) == 0 );
+        assert( unlink( name ) == 0 );
+    }
+
+    assert( stat( "spool/message-", &st ) == -1 );
+    assert( stat( "spool/message-000", &st ) == -1 );
+    assert( stat( "spool/message-02", &st ) == -1 );
+    assert( stat( "spool/message-03", &st ) == 0 );
+
+    DIR *d = opendir( "spool" );
+    assert( d );
+    struct dirent *e;
+    int next = 1;
+    while ( ( e = readdir( d ) ) )
+    {
+        if ( e->d_name[ 0 ] == '.' )
+            continue;
+        snprintf( name, sizeof name, "message-%02d", next );
+        assert( strcmp( e->d_name, name ) == 0 );
+        next += 2;
+    }
+    assert( next == 41 );
+    assert( closedir( d ) == 0 );
+
+    return 0;
+}
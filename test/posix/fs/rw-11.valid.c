@@ -0,0 +1,44 @@
+/* TAGS: c */
+#include <unistd.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <string.h>
+
+/* a log-like workload: many small appends, spanning several chunks */
+
+int main() {
+    char line[ 16 ], buf[ 16 ];
+    int fd = open( "log", O_CREAT | O_RDWR | O_APPEND, 0644 );
+    assert( fd >= 0 );
+
+    for ( int i = 0; i < 1000; ++i )
+    {
+        memset( line, 'a' + i % 26, 15 );
+        line[ 15 ] = '\n';
+        assert( write( fd, line, 16 ) == 16 );
+    }
+
+    assert( lseek( fd, 0, SEEK_END ) == 16000 );
+
+    for ( int i = 0; i < 1000; i += 37 )
+    {
+        assert( lseek( fd, 16 * i, SEEK_SET ) == 16 * i );
+        assert( read( fd, buf, 16 ) == 16 );
+        assert( buf[ 0 ] == 'a' + i % 26 && buf[ 14 ] == buf[ 0 ] && buf[ 15 ] == '\n' );
+    }
+
+    /* overwrite across a chunk boundary (the file is opened for append, so
+     * reopen it first) */
+    assert( close( fd ) == 0 );
+    fd = open( "log", O_RDWR );
+    assert( fd >= 0 );
+    assert( lseek( fd, 4090, SEEK_SET ) == 4090 );
+    assert( write( fd, "0123456789AB", 12 ) == 12 );
+    assert( lseek( fd, 4088, SEEK_SET ) == 4088 );
+    assert( read( fd, buf, 16 ) == 16 );
+    assert( memcmp( buf + 2, "0123456789AB", 12 ) == 0 );
+    assert( buf[ 0 ] == buf[ 14 ] );
+
+    assert( close( fd ) == 0 );
+    return 0;
+}
@@ -0,0 +1,41 @@
+/* TAGS: c */
+#include <unistd.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <string.h>
+
+/* holes and truncation in a file larger than a single chunk */
+
+int main() {
+    char buf[ 8 ];
+    int fd = open( "file", O_CREAT | O_RDWR, 0644 );
+    assert( fd >= 0 );
+
+    assert( lseek( fd, 100000, SEEK_SET ) == 100000 );
+    assert( write( fd, "tail", 4 ) == 4 );
+    assert( lseek( fd, 0, SEEK_END ) == 100004 );
+
+    assert( lseek( fd, 50000, SEEK_SET ) == 50000 );
+    memset( buf, 'x', 8 );
+    assert( read( fd, buf, 8 ) == 8 );
+    for ( int i = 0; i < 8; ++i )
+        assert( buf[ i ] == 0 );
+
+    assert( lseek( fd, 99998, SEEK_SET ) == 99998 );
+    assert( read( fd, buf, 8 ) == 6 );
+    assert( memcmp( buf, "\0\0tail", 6 ) == 0 );
+
+    /* shrink into the middle of a chunk, then grow again: the cut-off part
+     * must read back as zeroes */
+    assert( ftruncate( fd, 100002 ) == 0 );
+    assert( ftruncate( fd, 100006 ) == 0 );
+    assert( lseek( fd, 100000, SEEK_SET ) == 100000 );
+    assert( read( fd, buf, 8 ) == 6 );
+    assert( memcmp( buf, "ta\0\0\0\0", 6 ) == 0 );
+
+    assert( ftruncate( fd, 0 ) == 0 );
+    assert( lseek( fd, 0, SEEK_END ) == 0 );
+
+    assert( close( fd ) == 0 );
+    return 0;
+}
@@ -0,0 +1,67 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+
+/*
+ * (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* Convert a syscall trace recorded in passthrough mode into the indexed
+ * format (cf. dios/proxy/replay-trace.h), which the replay configuration can
+ * use without scanning through the trace in the interpreter. */
+
+#include <dios/proxy/replay-trace.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+int main( int argc, const char **argv )
+{
+    if ( argc != 3 )
+    {
+        std::cerr << "usage: " << argv[ 0 ] << " passthrough.out indexed.out" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in( argv[ 1 ], std::ios::binary );
+    std::string trace( ( std::istreambuf_iterator< char >( in ) ), std::istreambuf_iterator< char >() ),
+                indexed;
+
+    if ( !in.good() && !in.eof() )
+    {
+        std::cerr << "could not read " << argv[ 1 ] << std::endl;
+        return 1;
+    }
+
+    if ( __dios::replay::is_indexed( trace.data(), trace.size() ) )
+        indexed = trace;
+    else if ( !__dios::replay::index_stream( trace.data(), trace.size(), indexed ) )
+    {
+        std::cerr << argv[ 1 ] << " is not a valid syscall trace" << std::endl;
+        return 1;
+    }
+
+    std::ofstream out( argv[ 2 ], std::ios::binary | std::ios::trunc );
+    out.write( indexed.data(), indexed.size() );
+
+    if ( !out )
+    {
+        std::cerr << "could not write " << argv[ 2 ] << std::endl;
+        return 1;
+    }
+
+    std::cerr << "indexed " << __dios::replay::count( indexed.data() ) << " syscalls" << std::endl;
+    return 0;
+}